@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Converts a parkour hitch capture (Saved/Profiling/Hitches/*.pkhitch) into a readable timeline.
+
+One line per frame with the frame time, followed by one line per character that traced or had a traversal event in it.
+The frame that crossed the hitch threshold is marked with >>>.
+
+Usage: Scripts/ParkourHitchTimeline.py <capture.pkhitch> [--csv out.csv]
+
+The layout is documented next to ParkourHitchFormat in Source/parkour_GP4/parkour_GP4HitchCapture.h.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = 0x43484B50
+VERSION = 1
+
+# Bit order of EParkourTraversalEvent.
+EVENTS = ["SlideStart", "SlideEnd", "Vault", "Mantle", "SprintStop"]
+SPRINT_STATES = ["Stopped", "Started", "Sustained", "Stopping"]
+
+FLAG_SLIDING = 0x01
+FLAG_FALLING = 0x02
+FLAG_SPRINTING = 0x04
+SPRINT_STATE_SHIFT = 4
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def read(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.data, self.offset)
+        self.offset += struct.calcsize("<" + fmt)
+        return values
+
+    def read_bytes(self, count):
+        value = self.data[self.offset:self.offset + count]
+        self.offset += count
+        return value
+
+
+def parse(data):
+    reader = Reader(data)
+    magic, version = reader.read("IH")
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a version %d parkour hitch capture" % VERSION)
+
+    num_names, num_frames, hitch_frame, threshold_ms = reader.read("HIIf")
+
+    names = {}
+    for _ in range(num_names):
+        character_id, length = reader.read("IH")
+        names[character_id] = reader.read_bytes(length).decode("utf-8")
+
+    frames = []
+    for _ in range(num_frames):
+        frame_number, world_time, frame_ms, num_entries = reader.read("IffH")
+        entries = []
+        for _ in range(num_entries):
+            character_id, num_queries, events, flags = reader.read("IHBB")
+            entries.append({
+                "character": names.get(character_id, "#%d" % character_id),
+                "queries": num_queries,
+                "events": [name for bit, name in enumerate(EVENTS) if events & (1 << bit)],
+                "sliding": bool(flags & FLAG_SLIDING),
+                "falling": bool(flags & FLAG_FALLING),
+                "sprinting": bool(flags & FLAG_SPRINTING),
+                "sprint_state": SPRINT_STATES[(flags >> SPRINT_STATE_SHIFT) & 0x3],
+            })
+        frames.append({"frame": frame_number, "time": world_time, "ms": frame_ms, "entries": entries})
+
+    return {"hitch_frame": hitch_frame, "threshold_ms": threshold_ms, "frames": frames}
+
+
+def describe(entry):
+    state = []
+    if entry["sliding"]:
+        state.append("sliding")
+    if entry["falling"]:
+        state.append("falling")
+    if entry["sprinting"]:
+        state.append("sprinting")
+    state.append("sprint " + entry["sprint_state"])
+    events = " ".join(entry["events"])
+    return "%-32s %4d traces  %-24s %s" % (entry["character"], entry["queries"], events, ", ".join(state))
+
+
+def print_timeline(capture, out):
+    frames = capture["frames"]
+    out.write("Hitch at frame %d, threshold %.1f ms, %d frames captured\n\n" % (capture["hitch_frame"], capture["threshold_ms"], len(frames)))
+    for frame in frames:
+        marker = ">>>" if frame["ms"] > capture["threshold_ms"] else "   "
+        traces = sum(entry["queries"] for entry in frame["entries"])
+        out.write("%s frame %-8d t=%9.3fs %7.2f ms %5d traces\n" % (marker, frame["frame"], frame["time"], frame["ms"], traces))
+        for entry in frame["entries"]:
+            out.write("        " + describe(entry) + "\n")
+
+
+def write_csv(capture, path):
+    with open(path, "w", newline="") as csv_file:
+        writer = csv.writer(csv_file)
+        writer.writerow(["Frame", "WorldTime", "FrameMs", "Character", "Traces", "Events", "Sliding", "Falling", "Sprinting", "SprintState"])
+        for frame in capture["frames"]:
+            time, ms = "%.3f" % frame["time"], "%.2f" % frame["ms"]
+            for entry in frame["entries"] or [None]:
+                if entry is None:
+                    writer.writerow([frame["frame"], time, ms, "", 0, "", "", "", "", ""])
+                    continue
+                writer.writerow([frame["frame"], time, ms, entry["character"], entry["queries"], " ".join(entry["events"]),
+                                 int(entry["sliding"]), int(entry["falling"]), int(entry["sprinting"]), entry["sprint_state"]])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture")
+    parser.add_argument("--csv", help="also write one row per frame and character to this file")
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as capture_file:
+        capture = parse(capture_file.read())
+
+    print_timeline(capture, sys.stdout)
+    if args.csv:
+        write_csv(capture, args.csv)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Compares two parkour soak test runs (Saved/Profiling/ParkourSoak/*/server.csv) by number of connected clients.
+
+Every column is averaged over the samples taken with the same number of clients, the first seconds after a step are skipped
+while the new bots are still loading. The change from the first run to the second is printed next to each pair.
+
+Usage: Scripts/ParkourSoakCompare.py <baseline.csv> <candidate.csv> [--columns OutBytesPerSec,AvgWorldTickMs] [--settle 10]
+
+Typical use is a run with SOAK_NET_RATE=0 against one with SOAK_NET_RATE=1, see Scripts/ParkourSoakTest.sh.
+"""
+
+import argparse
+import csv
+import sys
+from collections import defaultdict
+
+DEFAULT_COLUMNS = ["OutBytesPerSec", "InBytesPerSec", "AvgWorldTickMs", "AvgFrameMs", "CorrectionsPerSec", "AvgNetUpdateHz", "TraversalTierCharacters", "CourseCulledPerSec"]
+
+
+def load(path, settle_seconds):
+    """Returns {clients: {column: average}} for one run."""
+    sums = defaultdict(lambda: defaultdict(float))
+    counts = defaultdict(int)
+    last_clients, step_start = None, 0.0
+
+    with open(path, newline="") as csv_file:
+        for row in csv.DictReader(csv_file):
+            clients, seconds = int(row["Clients"]), float(row["Seconds"])
+            if clients != last_clients:
+                last_clients, step_start = clients, seconds
+            if seconds - step_start < settle_seconds:
+                continue
+            counts[clients] += 1
+            for column, value in row.items():
+                try:
+                    sums[clients][column] += float(value)
+                except (TypeError, ValueError):
+                    pass
+
+    return {clients: {column: total / counts[clients] for column, total in columns.items()} for clients, columns in sums.items()}
+
+
+def change(baseline, candidate):
+    if baseline == 0.0:
+        return "      -"
+    return "%+6.1f%%" % ((candidate - baseline) * 100.0 / baseline)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--columns", default=",".join(DEFAULT_COLUMNS), help="comma separated CSV columns to compare")
+    parser.add_argument("--settle", type=float, default=10.0, help="seconds skipped after the client count changes")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.settle)
+    candidate = load(args.candidate, args.settle)
+    columns = args.columns.split(",")
+
+    out = sys.stdout
+    out.write("%-8s" % "Clients")
+    for column in columns:
+        out.write(" | %-34s" % column)
+    out.write("\n")
+
+    for clients in sorted(set(baseline) & set(candidate)):
+        out.write("%-8d" % clients)
+        for column in columns:
+            before = baseline[clients].get(column, 0.0)
+            after = candidate[clients].get(column, 0.0)
+            out.write(" | %11.2f %11.2f %s" % (before, after, change(before, after)))
+        out.write("\n")
+
+
+if __name__ == "__main__":
+    main()
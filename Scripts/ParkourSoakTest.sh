@@ -0,0 +1,76 @@
+#!/usr/bin/env bash
+# Local soak test for server tick capacity.
+#
+# Starts a dedicated (or listen) server on ParkourMap and ramps up headless bot clients over loopback.
+# The server writes one CSV row per second (world tick time, bandwidth, movement corrections, traces avoided by the traversal prefilter,
+# adaptive replication rates), which plotted against the Clients column gives the capacity curve.
+# To see what the adaptive replication buys, run once with SOAK_NET_RATE=0 and once with 1 and compare the two CSVs
+# with Scripts/ParkourSoakCompare.py.
+# TraversalTierCharacters counts the characters the server has at the traversal rate. It stays at 0 on a dedicated server
+# if the slide and traversal state of the bots does not reach it.
+# Culling along the course only happens on a map with an Aparkour_GP4Course. ParkourMap has none until one is placed along
+# the run, and the server log warns about it. Without one the comparison only measures the rate tiers. To measure culling, place one
+# or run on a map that has one with SOAK_MAP.
+#
+# Usage: Scripts/ParkourSoakTest.sh [max_bots] [bots_per_step] [step_seconds]
+#   UE_ROOT         Engine install, used to find UnrealEditor-Cmd when UE_EDITOR_CMD is not set.
+#   UE_EDITOR_CMD   Path to UnrealEditor-Cmd (or a packaged game/server binary).
+#   SOAK_MODE       "dedicated" (default) or "listen".
+#   SOAK_MAP        Map to run on, /Game/_Parkour/Maps/ParkourMap by default.
+#   SOAK_PORT       Server port, 7777 by default.
+#   SOAK_NET_RATE   Value of parkour.NetRate on the server and the bots, 1 by default.
+#   SOAK_RUN_DIR    Output directory, a new timestamped one under Saved/Profiling/ParkourSoak by default.
+
+set -euo pipefail
+
+MAX_BOTS=${1:-32}
+BOTS_PER_STEP=${2:-4}
+STEP_SECONDS=${3:-60}
+SOAK_MODE=${SOAK_MODE:-dedicated}
+SOAK_PORT=${SOAK_PORT:-7777}
+SOAK_NET_RATE=${SOAK_NET_RATE:-1}
+
+PROJECT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+PROJECT="$PROJECT_DIR/parkour_GP4.uproject"
+MAP=${SOAK_MAP:-/Game/_Parkour/Maps/ParkourMap}
+UE_EDITOR_CMD=${UE_EDITOR_CMD:-${UE_ROOT:?Set UE_ROOT or UE_EDITOR_CMD}/Engine/Binaries/Linux/UnrealEditor-Cmd}
+
+RUN_DIR=${SOAK_RUN_DIR:-"$PROJECT_DIR/Saved/Profiling/ParkourSoak/$(date +%Y%m%d-%H%M%S)"}
+mkdir -p "$RUN_DIR"
+CSV="$RUN_DIR/server.csv"
+
+PIDS=()
+cleanup() {
+	for pid in "${PIDS[@]}"; do
+		kill "$pid" 2>/dev/null || true
+	done
+	wait 2>/dev/null || true
+}
+trap cleanup EXIT INT TERM
+
+if [ "$SOAK_MODE" = "listen" ]; then
+	"$UE_EDITOR_CMD" "$PROJECT" "$MAP?listen" -game -nullrhi -nosound -unattended -Port="$SOAK_PORT" -dpcvars="parkour.NetRate=$SOAK_NET_RATE" \
+		-ParkourSoakStats -ParkourSoakCsv="$CSV" -log -abslog="$RUN_DIR/server.log" >/dev/null 2>&1 &
+else
+	"$UE_EDITOR_CMD" "$PROJECT" "$MAP" -server -nullrhi -nosound -unattended -Port="$SOAK_PORT" -dpcvars="parkour.NetRate=$SOAK_NET_RATE" \
+		-ParkourSoakStats -ParkourSoakCsv="$CSV" -log -abslog="$RUN_DIR/server.log" >/dev/null 2>&1 &
+fi
+PIDS+=($!)
+
+# Give the server time to load the map before the first clients connect.
+sleep 20
+
+BOTS=0
+while [ "$BOTS" -lt "$MAX_BOTS" ]; do
+	for _ in $(seq 1 "$BOTS_PER_STEP"); do
+		[ "$BOTS" -ge "$MAX_BOTS" ] && break
+		BOTS=$((BOTS + 1))
+		"$UE_EDITOR_CMD" "$PROJECT" "127.0.0.1:$SOAK_PORT" -game -nullrhi -nosound -unattended -dpcvars="parkour.NetRate=$SOAK_NET_RATE" \
+			-ParkourBot -ParkourBotSeed="$BOTS" -log -abslog="$RUN_DIR/bot$BOTS.log" >/dev/null 2>&1 &
+		PIDS+=($!)
+	done
+	echo "$(date +%T) $BOTS bots connected"
+	sleep "$STEP_SECONDS"
+done
+
+echo "Soak test finished, server stats in $CSV"
@@ -8,6 +8,13 @@ public class parkour_GP4 : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "AIModule", "NavigationSystem" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Chaos", "PhysicsCore" });
+
+		if (Target.bUseGameplayDebugger)
+		{
+			PrivateDependencyModuleNames.Add("GameplayDebugger");
+		}
 	}
 }
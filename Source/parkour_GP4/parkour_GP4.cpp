@@ -3,5 +3,34 @@
 #include "parkour_GP4.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, parkour_GP4, "parkour_GP4" );
- 
\ No newline at end of file
+#if WITH_GAMEPLAY_DEBUGGER
+#include "GameplayDebugger.h"
+#include "parkour_GP4GameplayDebuggerCategory.h"
+#endif
+
+class FParkourGP4GameModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+#if WITH_GAMEPLAY_DEBUGGER
+		IGameplayDebugger& GameplayDebuggerModule = IGameplayDebugger::Get();
+		GameplayDebuggerModule.RegisterCategory("Parkour", IGameplayDebugger::FOnGetCategory::CreateStatic(&FGameplayDebuggerCategory_Parkour::MakeInstance), EGameplayDebuggerCategoryState::EnabledInGameAndSimulate);
+		GameplayDebuggerModule.NotifyCategoriesChanged();
+#endif
+	}
+
+	virtual void ShutdownModule() override
+	{
+#if WITH_GAMEPLAY_DEBUGGER
+		if (IGameplayDebugger::IsAvailable())
+		{
+			IGameplayDebugger& GameplayDebuggerModule = IGameplayDebugger::Get();
+			GameplayDebuggerModule.UnregisterCategory("Parkour");
+			GameplayDebuggerModule.NotifyCategoriesChanged();
+		}
+#endif
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FParkourGP4GameModule, parkour_GP4, "parkour_GP4" );
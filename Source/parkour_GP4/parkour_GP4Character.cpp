@@ -1,12 +1,19 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "parkour_GP4Character.h"
+#include "parkour_GP4Ghost.h"
+#include "parkour_GP4MovementComponent.h"
+#include "parkour_GP4NetRate.h"
+#include "parkour_GP4Scalability.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalNavLink.h"
 #include "Engine/LocalPlayer.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/Controller.h"
+#include "HAL/IConsoleManager.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
@@ -17,10 +24,46 @@
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
+static TAutoConsoleVariable<bool> CVarSlideQueryCoherence(
+	TEXT("parkour.SlideQueryCoherence"),
+	true,
+	TEXT("Reuse the slide floor and surface checks while the character stays on the same floor. 0 traces on every check."));
+
+static TAutoConsoleVariable<bool> CVarSlideQueryCoherenceVerify(
+	TEXT("parkour.SlideQueryCoherence.Verify"),
+	false,
+	TEXT("Trace even when a cached slide check could be reused and log a warning when the cached result disagrees."));
+
+static TAutoConsoleVariable<float> CVarSlideQueryCoherenceMaxDistance(
+	TEXT("parkour.SlideQueryCoherence.MaxDistance"),
+	5.0f,
+	TEXT("Distance in cm the query location may move before a slide check is traced again."));
+
+static TAutoConsoleVariable<float> CVarSlideQueryCoherenceMinNormalDot(
+	TEXT("parkour.SlideQueryCoherence.MinNormalDot"),
+	0.995f,
+	TEXT("Minimum dot product between the cached and the current floor normal for a slide check to be reused."));
+
+static TAutoConsoleVariable<float> CVarSlideQueryCoherenceMaxAge(
+	TEXT("parkour.SlideQueryCoherence.MaxAge"),
+	0.1f,
+	TEXT("Seconds after which a cached slide check is always traced again."));
+
+static TAutoConsoleVariable<bool> CVarVaultBisectDepth(
+	TEXT("parkour.Vault.BisectDepth"),
+	true,
+	TEXT("Find the far side of a vault obstacle with a bisection search. 0 probes every depth step."));
+
+static TAutoConsoleVariable<bool> CVarVaultBisectDepthVerify(
+	TEXT("parkour.Vault.BisectDepth.Verify"),
+	false,
+	TEXT("Run the linear depth scan next to the bisection search and log a warning when the vault results disagree."));
+
 //////////////////////////////////////////////////////////////////////////
 // Aparkour_GP4Character
 
-Aparkour_GP4Character::Aparkour_GP4Character()
+Aparkour_GP4Character::Aparkour_GP4Character(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<Uparkour_GP4MovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	//GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -61,6 +104,7 @@ Aparkour_GP4Character::Aparkour_GP4Character()
 	SpeedToStopSliding = 50.0f;
 	SprintSpeed = 800.0f;
 	DefaultWalkSpeed = GetCharacterMovement()->MaxWalkSpeed;
+	TraversalQueries = FParkourTraversalQueries(this);
 
 	//// Create Motion Warping Component
 	//PMotionWarpingComponent = CreateDefaultSubobject<UMotionWarpingComponent>(TEXT("MotionWarping"));
@@ -80,6 +124,43 @@ void Aparkour_GP4Character::BeginPlay()
 			Subsystem->AddMappingContext(DefaultMappingContext, 0);
 		}
 	}
+
+	// Sprint transitions come from the movement tick instead of being polled
+	GetParkourMovement()->OnSprintStateChanged.AddDynamic(this, &Aparkour_GP4Character::HandleSprintStateChanged);
+
+	if (Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>())
+	{
+		TickManager->Register(this);
+	}
+}
+
+void Aparkour_GP4Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>())
+	{
+		TickManager->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/// <summary>
+/// On top of the usual owner and cull distance checks, characters far ahead or behind the viewer along the course are not replicated to it.
+/// </summary>
+bool Aparkour_GP4Character::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	if (!Super::IsNetRelevantFor(RealViewer, ViewTarget, SrcLocation))
+	{
+		return false;
+	}
+
+	if (bAlwaysRelevant || ViewTarget == this || IsOwnedBy(ViewTarget) || IsOwnedBy(RealViewer))
+	{
+		return true;
+	}
+
+	const Uparkour_GP4NetRateSubsystem* NetRate = GetWorld()->GetSubsystem<Uparkour_GP4NetRateSubsystem>();
+	return NetRate == nullptr || NetRate->IsRelevantAlongCourse(this, ViewTarget, SrcLocation);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -170,6 +251,10 @@ void Aparkour_GP4Character::Slide()
 		else
 		{
 			IsSliding = true;
+			bSlideEndPending = true;
+			NotifyTraversalEvent(EParkourTraversalEvent::SlideStart);
+			FloorCheckCache.bValid = false;
+			SurfaceCheckCache.bValid = false;
 
 			MeshP->GetAnimInstance()->Montage_Play(SlidingMontage);
 
@@ -207,7 +292,7 @@ void Aparkour_GP4Character::Slide()
 				GetCapsuleComponent()->SetCapsuleRadius();
 				*/
 			}
-			GetWorld()->GetTimerManager().SetTimer(SlideTraceHandle, this, &Aparkour_GP4Character::TraceFloorWhileSliding, 0.01f, true);
+			StartSlideTimer(EParkourSlideTimer::FloorCheck, ParkourScalability::GetSlideFloorCheckInterval());
 		}
 	}
 }
@@ -215,10 +300,10 @@ void Aparkour_GP4Character::Slide()
 void Aparkour_GP4Character::TraceFloorWhileSliding()
 {
 	CheckIfOnFloor();
-	GetWorld()->GetTimerManager().ClearTimer(SlideTraceHandle); // this might not work
-	if (ContinueSlidingHandle.IsValid())
+	StopSlideTimer(EParkourSlideTimer::FloorCheck); // this might not work
+	if (IsSlideTimerActive(EParkourSlideTimer::ContinueSliding))
 	{
-		GetWorld()->GetTimerManager().ClearTimer(ContinueSlidingHandle); // this might not work
+		StopSlideTimer(EParkourSlideTimer::ContinueSliding); // this might not work
 		GetCharacterMovement()->UnCrouch();
 		UE_LOG(LogTemp, Warning, TEXT("6ContinueSlidingHandle.IsValid()!!!"))
 		ResetXYRotation();
@@ -247,11 +332,15 @@ void Aparkour_GP4Character::CheckIfOnFloor()
 	float TraceRadius = 4.0f; // Radius of the capsule
 	float TraceHalfHeight = 18.0f; // Half-height of the capsule
 	float MontageBlendOutTime = 0.2f;
-	ETraceTypeQuery TraceChannel = UEngineTypes::ConvertToTraceType(ECC_Visibility); // Trace channel to use
 
-	// Perform the capsule trace
+	// Perform the capsule trace, unless the last one is still valid for this floor
 	FHitResult OutHit;
-	bool bHit = UKismetSystemLibrary::CapsuleTraceSingle(GetWorld(), Start, End, TraceRadius, TraceHalfHeight, TraceChannel, false, TArray<AActor*>(), EDrawDebugTrace::ForDuration, OutHit, true);
+	bool bHit = false;
+	if (!TryReuseSlideQuery(FloorCheckCache, Start, bHit, OutHit))
+	{
+		bHit = TraversalQueries.CapsuleTrace(TEXT("CheckIfOnFloor"), Start, End, TraceRadius, TraceHalfHeight, FParkourIgnoreActors(), OutHit);
+		UpdateSlideQuery(FloorCheckCache, TEXT("CheckIfOnFloor"), Start, bHit, OutHit);
+	}
 
 	// Check if the trace hit something
 	if (bHit)
@@ -261,8 +350,9 @@ void Aparkour_GP4Character::CheckIfOnFloor()
 	else
 	{
 		IsSliding = false;
+		NotifySlideEnded();
 		MeshP->GetAnimInstance()->Montage_Stop(MontageBlendOutTime);
-		GetWorld()->GetTimerManager().ClearTimer(SlideTraceHandle); // this might not work
+		StopSlideTimer(EParkourSlideTimer::FloorCheck); // this might not work
 		UE_LOG(LogTemp, Warning, TEXT("4Check If On Floor.... is sliding False!!!"))
 	}
 
@@ -277,7 +367,7 @@ void Aparkour_GP4Character::AlignPlayerToFloor()
 
 	FRotator TargetRotate(GetActorForwardVector().X, 0.0f, GetCharacterMovement()->CurrentFloor.HitResult.ImpactNormal.Z);
 
-	float deltaTime = GetWorld()->GetDeltaSeconds();
+	float deltaTime = GetSlideDeltaTime();
 
 	float InterpSpeed = 5.0f;
 
@@ -309,17 +399,20 @@ void Aparkour_GP4Character::CheckIfHitSurface()
 	float TraceZOffset = 0.0f;
 	FVector OffsetTraceVector(0, 0, TraceZOffset);
 	FVector TraceVector = MeshP->GetSocketLocation("foot_l") + OffsetTraceVector;
-	ETraceTypeQuery TraceChannel = UEngineTypes::ConvertToTraceType(ECC_Visibility); // Trace channel to use
 
-	TArray<AActor*> ActorsArray;
+	FParkourIgnoreActors ActorsArray;
 	ActorsArray.Add(GetCharacterMovement()->CurrentFloor.HitResult.GetActor());
 
 	float MontageBlendOutTime = 0.2f;
 
-	// Perform the sphere trace
+	// Perform the sphere trace, unless the last one is still valid for this floor
 	FHitResult OutHit;
-
-	bool bSphereHit = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), TraceVector, TraceVector, 20.0f, TraceChannel, false, ActorsArray, EDrawDebugTrace::ForDuration, OutHit, true, FLinearColor::Yellow);
+	bool bSphereHit = false;
+	if (!TryReuseSlideQuery(SurfaceCheckCache, TraceVector, bSphereHit, OutHit))
+	{
+		bSphereHit = TraversalQueries.SphereTrace(TEXT("CheckIfHitSurface"), TraceVector, TraceVector, 20.0f, ActorsArray, OutHit);
+		UpdateSlideQuery(SurfaceCheckCache, TEXT("CheckIfHitSurface"), TraceVector, bSphereHit, OutHit);
+	}
 
 
 	if (bSphereHit) // this is false because it doesn't hit surface.
@@ -342,8 +435,8 @@ void Aparkour_GP4Character::CheckIfHitSurface()
 		if (AbsoluteArcCosDegrees > CompareAngle)
 		{
 			UE_LOG(LogTemp, Warning, TEXT("12CheckIfHitSurface... AbsoluteArcCosDegrees > CompareAngle True!!!"))
-			GetWorld()->GetTimerManager().ClearTimer(SlideTraceHandle); // this might not work
-			GetWorld()->GetTimerManager().ClearTimer(ContinueSlidingHandle); // this might not work
+			StopSlideTimer(EParkourSlideTimer::FloorCheck); // this might not work
+			StopSlideTimer(EParkourSlideTimer::ContinueSliding); // this might not work
 			PlayGettingUpEvent();
 		}
 		else
@@ -369,7 +462,7 @@ void Aparkour_GP4Character::CheckShouldContinueSliding()
 		if (IsSlopeUp())  // not returning true, does not work. 
 		{
 			GetCharacterMovement()->Velocity = CurrentSlidingVelocity;
-			GetWorld()->GetTimerManager().SetTimer(ContinueSlidingHandle, this, &Aparkour_GP4Character::ContinueSliding, 0.001f, true);
+			StartSlideTimer(EParkourSlideTimer::ContinueSliding, ParkourScalability::GetSlideContinueInterval());
 
 			CurrentAngle = FindCurrentFloorAngleAndDirection();
 		}
@@ -424,12 +517,13 @@ void Aparkour_GP4Character::PlayGettingUpEvent()
 	FLatentActionInfo FLatentInfo;
 	UKismetSystemLibrary::RetriggerableDelay(GetWorld(), 0.05f, FLatentInfo); // might not work
 
-	if (SlideTraceHandle.IsValid())
+	if (IsSlideTimerActive(EParkourSlideTimer::FloorCheck))
 	{
-		GetWorld()->GetTimerManager().ClearTimer(SlideTraceHandle); // this might not work
+		StopSlideTimer(EParkourSlideTimer::FloorCheck); // this might not work
 		UE_LOG(LogTemp, Warning, TEXT("15PlayGettingUpEvent... MyTimerHandleSliding.IsValid() True!!!"))
 	}
 	GetCharacterMovement()->UnCrouch(); // this area might not work.
+	NotifySlideEnded();
 
 	ResetXYRotation();
 	UE_LOG(LogTemp, Warning, TEXT("16PlayGettingUpEvent!!!"))
@@ -439,14 +533,14 @@ void Aparkour_GP4Character::ContinueSliding()
 {
 	CurrentAngle = FindCurrentFloorAngleAndDirection();
 
-	float InterpFloat = FMath::FInterpTo(CurrentAngle, FindCurrentFloorAngleAndDirection(), GetWorld()->GetDeltaSeconds(), 0.4f);
+	float InterpFloat = FMath::FInterpTo(CurrentAngle, FindCurrentFloorAngleAndDirection(), GetSlideDeltaTime(), 0.4f);
 
 	// Use the FinterpTo return value if you want a smoother check. Use CurrrentAngle for a sharper stopping.
 	if (InterpFloat < 3.0f) // might not work, might need to be changed to greater than.
 	{
 		if (UKismetMathLibrary::VSize(GetCharacterMovement()->Velocity) < SpeedToStopSliding)
 		{
-			GetWorld()->GetTimerManager().ClearTimer(ContinueSlidingHandle); // this might not work
+			StopSlideTimer(EParkourSlideTimer::ContinueSliding); // this might not work
 			PlayGettingUpEvent();
 		}
 	}
@@ -474,7 +568,7 @@ void Aparkour_GP4Character::ResetXYRotation()
 	FRotator DefaultYawRotation(0.0f, 0.0f, GetActorRotation().Yaw);
 	// Timeline Equivalent - ResetSlideRotation.
 
-	float deltaTime = GetWorld()->GetDeltaSeconds();
+	float deltaTime = GetSlideDeltaTime();
 
 	float InterpSpeed = 5.0f;
 
@@ -486,6 +580,123 @@ void Aparkour_GP4Character::ResetXYRotation()
 	GetCharacterMovement()->MaxAcceleration = 1500.0f; // for how slow or fast the player speeds up.
 }
 
+/// <summary>
+/// Starts a looping slide timer, on the traversal tick manager while batching is enabled and on the timer manager otherwise.
+/// </summary>
+void Aparkour_GP4Character::StartSlideTimer(EParkourSlideTimer Timer, float Interval)
+{
+	Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>();
+	if (TickManager && Uparkour_GP4TraversalTickManager::IsBatchingEnabled())
+	{
+		TickManager->StartSlideTimer(this, Timer, Interval);
+	}
+	else
+	{
+		GetWorld()->GetTimerManager().SetTimer(GetSlideTimerHandle(Timer), FTimerDelegate::CreateUObject(this, &Aparkour_GP4Character::OnSlideTimer, Timer), Interval, true);
+	}
+}
+
+void Aparkour_GP4Character::StopSlideTimer(EParkourSlideTimer Timer)
+{
+	// The timer may have been started before batching was switched on or off, so both are cleared.
+	if (Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>())
+	{
+		TickManager->StopSlideTimer(this, Timer);
+	}
+	GetWorld()->GetTimerManager().ClearTimer(GetSlideTimerHandle(Timer));
+}
+
+bool Aparkour_GP4Character::IsSlideTimerActive(EParkourSlideTimer Timer) const
+{
+	const FTimerHandle& Handle = Timer == EParkourSlideTimer::FloorCheck ? SlideTraceHandle : ContinueSlidingHandle;
+	const Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>();
+	return Handle.IsValid() || (TickManager && TickManager->IsSlideTimerActive(this, Timer));
+}
+
+void Aparkour_GP4Character::OnSlideTimer(EParkourSlideTimer Timer)
+{
+	if (Timer == EParkourSlideTimer::FloorCheck)
+	{
+		TraceFloorWhileSliding();
+	}
+	else
+	{
+		ContinueSliding();
+	}
+}
+
+FTimerHandle& Aparkour_GP4Character::GetSlideTimerHandle(EParkourSlideTimer Timer)
+{
+	return Timer == EParkourSlideTimer::FloorCheck ? SlideTraceHandle : ContinueSlidingHandle;
+}
+
+float Aparkour_GP4Character::GetSlideDeltaTime() const
+{
+	return SlideStepDeltaTime > 0.0f ? SlideStepDeltaTime : GetWorld()->GetDeltaSeconds();
+}
+
+/// <summary>
+/// The slide checks run from timers that fire many times per frame, so most of them see the same floor and almost the same location.
+/// A cached result is reused while the character is on the same floor component with a similar normal and has not moved far.
+/// In verify mode the trace is still done and the caller gets the traced result, but the cache is kept so mismatches can be logged.
+/// </summary>
+bool Aparkour_GP4Character::TryReuseSlideQuery(FParkourSlideQueryCache& Cache, const FVector& QueryLocation, bool& bOutHit, FHitResult& OutHit) const
+{
+	Cache.bVerifying = false;
+
+	if (!CVarSlideQueryCoherence.GetValueOnGameThread() || !Cache.bValid)
+	{
+		return false;
+	}
+
+	const FFindFloorResult& CurrentFloor = GetCharacterMovement()->CurrentFloor;
+	if (!CurrentFloor.bBlockingHit || Cache.FloorComponent.Get() != CurrentFloor.HitResult.GetComponent())
+	{
+		return false;
+	}
+
+	if (FVector::DotProduct(Cache.FloorNormal, CurrentFloor.HitResult.ImpactNormal) < CVarSlideQueryCoherenceMinNormalDot.GetValueOnGameThread()
+		|| FVector::DistSquared(Cache.QueryLocation, QueryLocation) > FMath::Square(CVarSlideQueryCoherenceMaxDistance.GetValueOnGameThread())
+		|| GetWorld()->GetTimeSeconds() - Cache.QueryTime > CVarSlideQueryCoherenceMaxAge.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	if (CVarSlideQueryCoherenceVerify.GetValueOnGameThread())
+	{
+		Cache.bVerifying = true;
+		return false;
+	}
+
+	bOutHit = Cache.bHit;
+	OutHit = Cache.Hit;
+	return true;
+}
+
+void Aparkour_GP4Character::UpdateSlideQuery(FParkourSlideQueryCache& Cache, FName QueryName, const FVector& QueryLocation, bool bHit, const FHitResult& Hit)
+{
+	if (Cache.bVerifying)
+	{
+		Cache.bVerifying = false;
+
+		if (bHit != Cache.bHit || (bHit && !Hit.ImpactNormal.Equals(Cache.Hit.ImpactNormal, 0.01f)))
+		{
+			UE_LOG(LogTemplateCharacter, Warning, TEXT("%s: cached %s result (hit %d) differs from the trace (hit %d) after moving %.2f cm"),
+				*GetName(), *QueryName.ToString(), Cache.bHit, bHit, FVector::Dist(Cache.QueryLocation, QueryLocation));
+		}
+		return;
+	}
+
+	const FFindFloorResult& CurrentFloor = GetCharacterMovement()->CurrentFloor;
+	Cache.FloorComponent = CurrentFloor.HitResult.GetComponent();
+	Cache.FloorNormal = CurrentFloor.HitResult.ImpactNormal;
+	Cache.QueryLocation = QueryLocation;
+	Cache.QueryTime = GetWorld()->GetTimeSeconds();
+	Cache.bHit = bHit;
+	Cache.Hit = Hit;
+	Cache.bValid = CurrentFloor.bBlockingHit;
+}
+
 /*
 * Check If Ceiling is above player before trying to get up when slide ends.
 */
@@ -494,13 +705,11 @@ void Aparkour_GP4Character::TraceForCeiling()
 	FVector TraceVector = GetActorLocation();
 	TraceVector.Z += 70.0f;
 
-	ETraceTypeQuery TraceChannel = UEngineTypes::ConvertToTraceType(ECC_Visibility); // Trace channel to use
-
-	TArray<AActor*> ActorsArray;
+	FParkourIgnoreActors ActorsArray;
 	//ActorsArray.Add(GetCharacterMovement()->CurrentFloor.HitResult.GetActor());
 	FHitResult OutHit; //Trace Ceiling? Video 39:02 to uncrouch automatically
 
-	bool bCapsuleHit = UKismetSystemLibrary::CapsuleTraceSingle(GetWorld(), TraceVector, TraceVector, 34.0f, 50.0f, TraceChannel, false, ActorsArray, EDrawDebugTrace::ForDuration, OutHit, true);
+	bool bCapsuleHit = TraversalQueries.CapsuleTrace(TEXT("TraceForCeiling"), TraceVector, TraceVector, 34.0f, 50.0f, ActorsArray, OutHit);
 
 	if (bCapsuleHit)
 	{
@@ -517,130 +726,63 @@ void Aparkour_GP4Character::TraceForCeiling()
 
 bool Aparkour_GP4Character::Vaulting()
 {
-	if (UKismetMathLibrary::VSize(GetCharacterMovement()->Velocity) > 450.0f && !GetCharacterMovement()->IsFalling())
-	{
-		return true;
-	}
-	return false;
+	return ParkourTraversal::ShouldVault(UKismetMathLibrary::VSize(GetCharacterMovement()->Velocity), GetCharacterMovement()->IsFalling());
 }
 
 
 void Aparkour_GP4Character::VaultTrace(float InitialTraceLength, float SecondaryTraceZOffset, float SecondaryTraceGap, float LandingPositionForwardOffset)
 {
-
 	/*
-		Do a line trace to trace for the object to vault over. If an object is found, the script continues to find the target locations.
-		Vault distance is set to 0 so it can be incremented to find the vaulting distance and play different montages based on it.
+		The trace chain itself lives in ParkourTraversal::AnalyzeVault so offline tools can run the same decision without a character.
+		With nothing in reach the obstacle trace misses and the chain leaves the last result as it is, so it is not run at all.
 	*/
-
-	FVector StartVector = GetActorLocation();
-
-	FVector MultipliedVector = GetActorForwardVector() * InitialTraceLength;
-
-	FVector EndVector = GetActorLocation() + MultipliedVector;
-
-	FHitResult OutHit;
-	ETraceTypeQuery TraceChannel = UEngineTypes::ConvertToTraceType(ECC_Visibility); // Trace channel to use
-	TArray<AActor*> ActorsArray;
-	//EDrawDebugTrace::Type DrawDebugType = EDrawDebugTrace::ForDuration;
-	bool bSingleHit = UKismetSystemLibrary::LineTraceSingle(GetWorld(), StartVector, EndVector, TraceChannel, false, ActorsArray, EDrawDebugTrace::None, OutHit, true);
-
-	if (bSingleHit)
+	if (!TraversalPrefilter.HasTraversablesInReach(TraversalQueries, GetActorLocation(), GetActorForwardVector(), InitialTraceLength))
 	{
-		VaultDistance = 0;
-		for (int i = 0; i < 10; i++)
-		{
-			/*
-			* Sphere Traces used to determine the length of the object and height.
-			*/
-
-			VaultDistance++;
-			FVector MultiVector = GetActorForwardVector() * i * SecondaryTraceGap;
-			FVector EndHitLocation = OutHit.Location + MultiVector;
-			FVector AddedVector = EndHitLocation;
-			AddedVector.Z += SecondaryTraceZOffset;
-			TArray<AActor*> ActorsArray2;
-			FHitResult OutHit2;
-
-			bool bSphereHit = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), AddedVector, EndHitLocation, 10.0f, TraceChannel, false, ActorsArray2, EDrawDebugTrace::None, OutHit2, true);
-
-			if (bSphereHit)
-			{
-				if (i == 0)
-				{
-					/*
-					* If it is the first/initial trace then the vault starting location is set and a sphere trace is used to check if there is anything blocking so the vault can be cancelled if there is.
-					*/
-
-					VaultStartLocation = OutHit2.ImpactPoint;
-					FVector AddToVaultStartVector = VaultStartLocation;
-					AddToVaultStartVector.Z += 20.0f;
-
-					TArray<AActor*> ActorsArray3;
-					FHitResult OutHit3;
-
-					bool bSphereHit2 = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), AddToVaultStartVector, AddToVaultStartVector, 10.0f, TraceChannel, false, ActorsArray3, EDrawDebugTrace::None, OutHit3, true, FLinearColor::Blue);
-					if (bSphereHit2)
-					{
-						CanVault = false;
-						break;  // Not sure if Breaks For Loop or just statement
-					}
-				}
-				else
-				{
-
-					/*
-					* if the Trace is not the initial one then the vault middle/height location is set by setting it every time a trace is done, making the final trace the target middle location.
-					*/
-
-					VaultMiddleLocation = OutHit2.ImpactPoint;
-					TArray<AActor*> ActorsArray4;
-					FHitResult OutHit4;
-
-					bool bSphereHit3 = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), OutHit2.TraceStart, OutHit2.TraceStart, 10.0f, TraceChannel, false, ActorsArray4, EDrawDebugTrace::None, OutHit4, true, FLinearColor::Blue);
-					if (bSphereHit3)
-					{
-						CanVault = false;
-					}
-				}
-			}
-			else
-			{
-				CanVault = true;
-
-				/*
-				* Find the landing location by doing a line trace downwards from an offset so it is not directly tracing down to the object but to the floor.
-				*/
-
-				FHitResult OutHit5;
-				TArray<AActor*> ActorsArray5;
-
-				FVector MultiplyForwardVector = GetActorForwardVector() * LandingPositionForwardOffset;
-
-				FVector StartTraceEndAddVector = OutHit2.TraceEnd + MultiplyForwardVector;
-
-				FVector EndTraceEndAddVector = StartTraceEndAddVector;
-				EndTraceEndAddVector.Z -= 100.0f;
-
-				bool bSingleHit4 = UKismetSystemLibrary::LineTraceSingle(GetWorld(), StartTraceEndAddVector, EndTraceEndAddVector, TraceChannel, false, ActorsArray5, EDrawDebugTrace::None, OutHit5, true);
+		return;
+	}
 
-				TArray<AActor*> ActorsArray6;
-				FHitResult OutHit6;
-				bool bSphereHit5 = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), StartTraceEndAddVector, StartTraceEndAddVector, 20.0f, TraceChannel, false, ActorsArray6, EDrawDebugTrace::None, OutHit6, true, FLinearColor::Blue);
+	FParkourVaultParams Params;
+	Params.InitialTraceLength = InitialTraceLength;
+	Params.SecondaryTraceZOffset = SecondaryTraceZOffset;
+	Params.SecondaryTraceGap = SecondaryTraceGap;
+	Params.LandingPositionForwardOffset = LandingPositionForwardOffset;
+	Params.MaxDepthSteps = ParkourScalability::GetVaultDepthSteps();
+	Params.bBisectDepth = CVarVaultBisectDepth.GetValueOnGameThread();
+
+	FParkourVaultResult Result;
+	Result.VaultStartLocation = VaultStartLocation;
+	Result.VaultMiddleLocation = VaultMiddleLocation;
+	Result.VaultLandLocation = VaultLandLocation;
+	Result.VaultDistance = VaultDistance;
+	Result.CanVault = CanVault;
+
+	const FParkourVaultResult PreviousResult = Result;
+	ParkourTraversal::AnalyzeVault(TraversalQueries, Params, GetActorLocation(), GetActorForwardVector(), Result);
+
+	if (Params.bBisectDepth && CVarVaultBisectDepthVerify.GetValueOnGameThread())
+	{
+		FParkourVaultParams LinearParams = Params;
+		LinearParams.bBisectDepth = false;
+		FParkourVaultResult LinearResult = PreviousResult;
+		ParkourTraversal::AnalyzeVault(TraversalQueries, LinearParams, GetActorLocation(), GetActorForwardVector(), LinearResult);
 
-				if (bSphereHit5)
-				{
-					CanVault = false;
-				}
-				else
-				{
-					VaultLandLocation = OutHit5.Location;
+		if (!ParkourTraversal::VaultResultsMatch(Result, LinearResult))
+		{
+			UE_LOG(LogTemplateCharacter, Warning, TEXT("'%s' Vault depth bisection disagrees with the linear scan: CanVault %d/%d, VaultDistance %d/%d"),
+				*GetNameSafe(this), Result.CanVault, LinearResult.CanVault, Result.VaultDistance, LinearResult.VaultDistance);
+		}
+	}
 
-				}
+	VaultStartLocation = Result.VaultStartLocation;
+	VaultMiddleLocation = Result.VaultMiddleLocation;
+	VaultLandLocation = Result.VaultLandLocation;
+	VaultDistance = Result.VaultDistance;
+	CanVault = Result.CanVault;
 
-				break;  // not sure if break out of for Loop and If this is correct or not. might not work.
-			}
-		}
+	// CanVault can still be set from an earlier trace, only a vault found by this one is an event.
+	if (Result.bVaultFound)
+	{
+		NotifyTraversalEvent(EParkourTraversalEvent::Vault, Result.VaultDistance);
 	}
 }
 
@@ -651,176 +793,154 @@ void Aparkour_GP4Character::VaultTrace(float InitialTraceLength, float Secondary
 
 void Aparkour_GP4Character::MantleTrace(float InitialTraceLength, float SecondaryTraceZOffset, float FallingHeightMultiplier)
 {
-	CanMantle = false;
-
 	/*
-		Trace to check for an object.
+		The trace chain itself lives in ParkourTraversal::AnalyzeMantle so offline tools can run the same decision without a character.
 	*/
+	if (!TraversalPrefilter.HasTraversablesInReach(TraversalQueries, GetActorLocation(), GetActorForwardVector(), InitialTraceLength))
+	{
+		CanMantle = false;
+		return;
+	}
 
-	FVector StartVector = GetActorLocation();
-	FVector MultipliedVector = GetActorForwardVector() * InitialTraceLength;
-	FVector EndVector = GetActorLocation() + MultipliedVector;
+	FParkourMantleParams Params;
+	Params.InitialTraceLength = InitialTraceLength;
+	Params.SecondaryTraceZOffset = SecondaryTraceZOffset;
+	Params.FallingHeightMultiplier = FallingHeightMultiplier;
 
-	FHitResult OutHit;
-	ETraceTypeQuery TraceChannel = UEngineTypes::ConvertToTraceType(ECC_Visibility); // Trace channel to use
-	TArray<AActor*> ActorsArray;
-	//EDrawDebugTrace::Type DrawDebugType = EDrawDebugTrace::ForDuration;
-	bool bSingleHit = UKismetSystemLibrary::LineTraceSingle(GetWorld(), StartVector, EndVector, TraceChannel, false, ActorsArray, EDrawDebugTrace::None, OutHit, true);
+	FParkourMantleResult Result;
+	Result.MantlePosition1 = MantlePosition1;
+	Result.MantlePosition2 = MantlePosition2;
 
-	if (bSingleHit)
-	{
-		/*
-			If an object is found then trace for the object height. If player is falling then the maximum reachable height is lowered.
-		*/
+	ParkourTraversal::AnalyzeMantle(TraversalQueries, Params, GetActorLocation(), GetActorForwardVector(), GetCharacterMovement()->IsFalling(), Result);
 
-		float SelectedFloat = UKismetMathLibrary::SelectFloat(FallingHeightMultiplier, 1.0f, GetCharacterMovement()->IsFalling());
-		float Multiplingfloat = SecondaryTraceZOffset * SelectedFloat;
-		FVector StartVectorForSphere = OutHit.Location;
-		StartVectorForSphere.Z += Multiplingfloat;
+	MantlePosition1 = Result.MantlePosition1;
+	MantlePosition2 = Result.MantlePosition2;
+	CanMantle = Result.CanMantle;
 
-		TArray<AActor*> ActorsArray2;
-		FHitResult OutHit2;
+	if (CanMantle)
+	{
+		NotifyTraversalEvent(EParkourTraversalEvent::Mantle);
+	}
+}
 
-		bool bSphereHit = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), StartVectorForSphere, OutHit.Location, 10.0f, TraceChannel, false, ActorsArray2, EDrawDebugTrace::None, OutHit2, true);
-		if (bSphereHit)
-		{
 
-			/*
-				Find the positions to motion warp to using the detected points from the trace.
-			*/
-			MantlePosition1 = OutHit2.ImpactPoint + (GetActorForwardVector() * -50.0f);
-			MantlePosition2 = (GetActorForwardVector() * 120.0f) + OutHit2.ImpactPoint;
 
 
-			CanMantle = true;
+#pragma region AI Traversal
 
-			FVector VectorForSphereTrace = MantlePosition2;
-			VectorForSphereTrace.Z += 20.0f;
-			TArray<AActor*> ActorsArray3;
-			FHitResult OutHit3;
+/// <summary>
+/// AI characters path over obstacles through the generated traversal nav links.
+/// The link already knows where the vault or mantle starts and lands, so the points are copied over instead of running VaultTrace/MantleTrace.
+/// </summary>
+void Aparkour_GP4Character::StartNavLinkTraversal(Aparkour_GP4TraversalNavLink* Link)
+{
+	ActiveTraversalLink = Link;
 
-			/*
-				Do a sphere trace to check if the player has enough space to land at the target location once mantled. This deduces the second motion warp location.
-			*/
-			bool bSphereHit2 = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), VectorForSphereTrace, VectorForSphereTrace, 10.0f, TraceChannel, false, ActorsArray3, EDrawDebugTrace::None, OutHit3, true);
-			if (bSphereHit2)
-			{
-				CanMantle = false;
-
-				if (MantlePosition1 == FVector(0.0f, 0.0f, 0.0f) || MantlePosition2 == FVector(0.0f, 0.0f, 0.0f))
-				{
-					CanMantle = false;
-				}
-				else
-				{
-					FVector EndVectorForSphere4 = MantlePosition2;
-					EndVectorForSphere4.Z += 100.0f;
-					FVector MakeVectorMantle1(MantlePosition1.X, MantlePosition1.Y, EndVectorForSphere4.Z);
-
-					TArray<AActor*> ActorsArray4;
-					FHitResult OutHit4;
-					/*
-						Do a final trace to check if the path from the first and second mantle position is clear.
-					*/
-					bool bSphereHit3 = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), MakeVectorMantle1, EndVectorForSphere4, 20.0f, TraceChannel, false, ActorsArray4, EDrawDebugTrace::None, OutHit4, true);
-
-					if (bSphereHit3)
-					{
-						CanMantle = false;
-						// return mantle1Pos and mantle2Pos
-					}
-					else
-					{
-						// return mantle1Pos and mantle2Pos
-					}
-				}
-			}
-			else
-			{
-				MantlePosition2 = (GetActorForwardVector() * 50.0f) + OutHit2.ImpactPoint;
-
-				if (MantlePosition1 == FVector(0.0f, 0.0f, 0.0f) || MantlePosition2 == FVector(0.0f, 0.0f, 0.0f))
-				{
-					CanMantle = false;
-				}
-				else
-				{
-					FVector EndVectorForSphere5 = MantlePosition2;
-					EndVectorForSphere5.Z += 100.0f;
-					FVector MakeVectorMantle1_2(MantlePosition1.X, MantlePosition1.Y, EndVectorForSphere5.Z);
-
-					TArray<AActor*> ActorsArray4;
-					FHitResult OutHit4;
-					/*
-						Do a final trace to check if the path from the first and second mantle position is clear.
-					*/
-					bool bSphereHit3 = UKismetSystemLibrary::SphereTraceSingle(GetWorld(), MakeVectorMantle1_2, EndVectorForSphere5, 20.0f, TraceChannel, false, ActorsArray4, EDrawDebugTrace::None, OutHit4, true);
-
-					if (bSphereHit3)
-					{
-						CanMantle = false;
-						// return mantle1Pos and mantle2Pos
-					}
-					else
-					{
-						// return mantle1Pos and mantle2Pos
-					}
-				}
-			}
-		}
+	FVector LinkDirection = Link->LandLocation - Link->StartLocation;
+	LinkDirection.Z = 0.0f;
+	SetActorRotation(FRotator(0.0f, LinkDirection.Rotation().Yaw, 0.0f));
+
+	if (Link->TraversalType == EParkourTraversalType::Vault)
+	{
+		VaultStartLocation = Link->StartLocation;
+		VaultMiddleLocation = Link->MiddleLocation;
+		VaultLandLocation = Link->LandLocation;
+		VaultDistance = Link->VaultDistance;
+		CanVault = true;
 	}
 	else
 	{
-		CanMantle = false;
+		MantlePosition1 = Link->StartLocation;
+		MantlePosition2 = Link->LandLocation;
+		CanMantle = true;
+	}
+
+	OnNavLinkTraversal(Link->TraversalType);
+}
 
+void Aparkour_GP4Character::FinishNavLinkTraversal()
+{
+	if (Aparkour_GP4TraversalNavLink* Link = ActiveTraversalLink.Get())
+	{
+		Link->ResumePathFollowing(this);
 	}
+	ActiveTraversalLink.Reset();
 }
 
+#pragma endregion
+
 
 
 
 void Aparkour_GP4Character::StartSprinting()
 {
 	IsSprinting = true;
-	GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
-
+	GetParkourMovement()->SetWantsToSprint(true);
 }
 
 void Aparkour_GP4Character::CompletedSprinting()
 {
-	GetCharacterMovement()->MaxWalkSpeed = DefaultWalkSpeed;
+	GetParkourMovement()->SetWantsToSprint(false);
 }
 
+/// <summary>
+/// Returns if the player is moving with input. Reads the value the movement component already worked out this tick.
+/// Simulated proxies have no input, for them the replicated sprint state tells if the owner is sprinting.
+/// </summary>
 bool Aparkour_GP4Character::TriggeredSprinting()
 {
-	if (UKismetMathLibrary::VSizeXY(GetCharacterMovement()->Velocity) > 10.0f 
-		&& GetCharacterMovement()->GetCurrentAcceleration() != FVector(0.0f, 0.0f, 0.0f))
+	const Uparkour_GP4MovementComponent* Movement = GetParkourMovement();
+	if (Movement->ShouldUpdateSprintState())
 	{
-		return true;
+		return Movement->IsMovingWithInput();
 	}
 
-	return false;
+	const EParkourSprintState SprintState = Movement->GetSprintState();
+	return SprintState == EParkourSprintState::Started || SprintState == EParkourSprintState::Sustained;
 }
 
 /// <summary>
-/// Play run stop montage by checking first if player was sprinting for long enough and then stopped sprinting.
-/// Player also has to have been moving above a certain speed so the run stop only plays if enough velocity was actually reached for this animation to be needed to play.
+/// Kept for Blueprints that still call it after the sprint input completes.
+/// The run stop montage is played from HandleSprintStateChanged now, so this does nothing.
 /// </summary>
 void Aparkour_GP4Character::AfterCompletedSprinting()
 {
-	if (GetCharacterMovement()->IsFalling())
+}
+
+void Aparkour_GP4Character::NotifyTraversalEvent(EParkourTraversalEvent Event, int32 InVaultDistance)
+{
+	PendingTraversalEvents |= 1 << static_cast<uint8>(Event);
+	Uparkour_GP4GhostSubsystem::RecordEvent(this, Event, InVaultDistance);
+	Uparkour_GP4NetRateSubsystem::BeginTraversalBurst(this);
+}
+
+/// <summary>
+/// A slide ends either by sliding off the floor or by getting up, and the getting up can still follow sliding off.
+/// Only the first of them after a SlideStart is passed on as SlideEnd.
+/// </summary>
+void Aparkour_GP4Character::NotifySlideEnded()
+{
+	if (bSlideEndPending)
 	{
+		bSlideEndPending = false;
+		NotifyTraversalEvent(EParkourTraversalEvent::SlideEnd);
+	}
+}
 
+/// <summary>
+/// Play run stop montage when the sprint state machine goes into stopping, which only happens if the player was sprinting,
+/// is on the ground and was moving above a certain speed, so the run stop only plays if enough velocity was actually reached for this animation to be needed to play.
+/// </summary>
+void Aparkour_GP4Character::HandleSprintStateChanged(EParkourSprintState NewState, EParkourSprintState PreviousState)
+{
+	if (NewState == EParkourSprintState::Started)
+	{
+		IsSprinting = true;
 	}
-	else if(IsSprinting)
+	else if (NewState == EParkourSprintState::Stopping)
 	{
-		if (UKismetMathLibrary::VSize(GetCharacterMovement()->GetLastUpdateVelocity()) > 50.0f)
-		{
-
-			IsSprinting = false;
-			MeshP->GetAnimInstance()->Montage_Play(RunToStopMontage);
-		}
+		IsSprinting = false;
+		MeshP->GetAnimInstance()->Montage_Play(RunToStopMontage);
+		NotifyTraversalEvent(EParkourTraversalEvent::SprintStop);
 	}
 }
-
-
@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "parkour_GP4MovementComponent.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalPrefilter.h"
+#include "parkour_GP4TraversalQueries.h"
+#include "parkour_GP4TraversalTickManager.h"
 #include "parkour_GP4Character.generated.h"
 
 class USpringArmComponent;
@@ -14,10 +19,24 @@ class UInputAction;
 class USkeletalMeshComponent;
 class UAnimMontage;
 class UMotionWarpingComponent;
+class Aparkour_GP4TraversalNavLink;
 struct FInputActionValue;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
+/** Result of a slide floor/surface check, reused while the character keeps sliding over the same floor. */
+struct FParkourSlideQueryCache
+{
+	TWeakObjectPtr<UPrimitiveComponent> FloorComponent;
+	FVector FloorNormal = FVector::ZeroVector;
+	FVector QueryLocation = FVector::ZeroVector;
+	double QueryTime = 0.0;
+	bool bHit = false;
+	FHitResult Hit;
+	bool bValid = false;
+	bool bVerifying = false;
+};
+
 UCLASS(config=Game)
 class Aparkour_GP4Character : public ACharacter
 {
@@ -62,7 +81,7 @@ class Aparkour_GP4Character : public ACharacter
 		UInputAction* LookAction;
 
 public:
-	Aparkour_GP4Character();
+	Aparkour_GP4Character(const FObjectInitializer& ObjectInitializer);
 	
 
 protected:
@@ -93,6 +112,15 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Movement")
 		void TraceForCeiling();
 
+	// Repeating slide checks, run by the traversal tick manager when it is enabled and by the timer manager otherwise.
+	void StartSlideTimer(EParkourSlideTimer Timer, float Interval);
+	void StopSlideTimer(EParkourSlideTimer Timer);
+	bool IsSlideTimerActive(EParkourSlideTimer Timer) const;
+	void OnSlideTimer(EParkourSlideTimer Timer);
+	FTimerHandle& GetSlideTimerHandle(EParkourSlideTimer Timer);
+	/** Delta time for the slide interpolation, the fixed step while the tick manager steps with physics and the frame time otherwise. */
+	float GetSlideDeltaTime() const;
+
 	/******   *******
 	**   Vaulting   **
 	******   *******/
@@ -109,6 +137,23 @@ protected:
 		void MantleTrace(float InitialTraceLength, float SecondaryTraceZOffset, float FallingHeightMultiplier);
 
 
+	/******   *******
+	**   AI Traversal   **
+	******   *******/
+public:
+	/** Called by a traversal nav link when an AI reaches it. Uses the points found offline instead of tracing. */
+	void StartNavLinkTraversal(Aparkour_GP4TraversalNavLink* Link);
+protected:
+	/** Play the vault or mantle for the points set by StartNavLinkTraversal, same as after a successful VaultTrace/MantleTrace. */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Movement")
+		void OnNavLinkTraversal(EParkourTraversalType TraversalType);
+	/** Call once the traversal montage is done so the AI carries on along its path. */
+	UFUNCTION(BlueprintCallable, Category = "Movement")
+		void FinishNavLinkTraversal();
+
+	TWeakObjectPtr<Aparkour_GP4TraversalNavLink> ActiveTraversalLink;
+
+
 	/******   *******
 	**   Sprinting   **
 	******   *******/
@@ -118,8 +163,20 @@ protected:
 		void CompletedSprinting();
 	UFUNCTION(BlueprintPure, Category = "Movement")
 		bool TriggeredSprinting();
-	UFUNCTION(BlueprintCallable, Category = "Movement")
+	UFUNCTION(BlueprintCallable, Category = "Movement", meta = (DeprecatedFunction, DeprecationMessage = "The run to stop now plays from the sprint state machine, bind to OnSprintStateChanged on the movement component instead."))
 		void AfterCompletedSprinting();
+	UFUNCTION()
+		void HandleSprintStateChanged(EParkourSprintState NewState, EParkourSprintState PreviousState);
+
+	/** Passes a traversal event on to the ghost recording, the hitch capture and the net rate subsystem. */
+	void NotifyTraversalEvent(EParkourTraversalEvent Event, int32 InVaultDistance = 0);
+	/** Sends SlideEnd once for the slide that is in progress. */
+	void NotifySlideEnded();
+
+
+	// Frame to frame reuse of the slide checks while the character stays on the same floor with a similar normal.
+	bool TryReuseSlideQuery(FParkourSlideQueryCache& Cache, const FVector& QueryLocation, bool& bOutHit, FHitResult& OutHit) const;
+	void UpdateSlideQuery(FParkourSlideQueryCache& Cache, FName QueryName, const FVector& QueryLocation, bool bHit, const FHitResult& Hit);
 
 
 protected:
@@ -128,12 +185,23 @@ protected:
 	
 	// To add mapping context
 	virtual void BeginPlay();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// AActor interface
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
 
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
+	/** Returns the parkour movement component **/
+	FORCEINLINE Uparkour_GP4MovementComponent* GetParkourMovement() const { return Cast<Uparkour_GP4MovementComponent>(GetCharacterMovement()); }
+	/** Returns the input actions so bots can drive the character the same way a player does **/
+	FORCEINLINE UInputAction* GetJumpAction() const { return JumpAction; }
+	FORCEINLINE UInputAction* GetSlideAction() const { return SlideAction; }
+	FORCEINLINE UInputAction* GetSprintAction() const { return SprintAction; }
+	FORCEINLINE UInputAction* GetMoveAction() const { return MoveAction; }
 
 	UPROPERTY(EditAnywhere, Category = Mesh)
 		USkeletalMeshComponent* MeshP;
@@ -159,6 +227,9 @@ public:
 	UPROPERTY(EditAnywhere, Category = Movement)
 		float SpeedToStopSliding;
 
+	FParkourSlideQueryCache FloorCheckCache;
+	FParkourSlideQueryCache SurfaceCheckCache;
+
 
 	// Vaulting
 
@@ -194,5 +265,44 @@ public:
 		bool DoOnceNodeBool;
 	UPROPERTY(EditAnywhere, Category = Animation)
 		UAnimMontage* RunToStopMontage;
+
+	/** Number of traversal traces this character made so far **/
+	uint32 GetNumTraversalQueries() const { return TraversalQueries.GetNumQueries(); }
+	/** Returns the traversal events since the last call as a mask of 1 << EParkourTraversalEvent and clears them **/
+	uint8 ConsumeTraversalEvents() { const uint8 Events = PendingTraversalEvents; PendingTraversalEvents = 0; return Events; }
+
+#if WITH_GAMEPLAY_DEBUGGER
+	/** Returns the last traversal queries of this character **/
+	const FParkourTraversalQueryHistory& GetTraversalQueryHistory() const { return TraversalQueries.GetHistory(); }
+	/** Keeps recording the traversal queries of this character for the next Seconds **/
+	void RecordTraversalQueriesFor(float Seconds) { TraversalQueries.RecordFor(Seconds); }
+#endif
+
+private:
+	friend class Uparkour_GP4TraversalTickManager;
+	friend class Uparkour_GP4NetRateSubsystem;
+
+	/** All traversal traces of this character go through here. */
+	FParkourTraversalQueries TraversalQueries;
+
+	/** Skips the vault and mantle chains while nothing is within reach. */
+	FParkourTraversalPrefilter TraversalPrefilter;
+
+	/** Index of this character in the traversal tick manager's arrays. */
+	int32 TraversalTickIndex = INDEX_NONE;
+
+	/** Set by the traversal tick manager while it calls a slide timer for a fixed step. */
+	float SlideStepDeltaTime = 0.0f;
+
+	uint8 PendingTraversalEvents = 0;
+
+	/** Set by SlideStart until the SlideEnd for that slide was sent. */
+	bool bSlideEndPending = false;
+
+	/** World time until which the character replicates at the traversal rate. */
+	double NetBurstEndTime = 0.0;
+
+	/** Distance along the map's course, updated by the net rate subsystem on the server. Negative while unknown. */
+	float CourseDistance = -1.0f;
 };
 
@@ -0,0 +1,341 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4CollisionAuditCommandlet.h"
+#include "parkour_GP4CommandletWorld.h"
+#include "Chaos/Convex.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "StaticMeshResources.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogParkourCollisionAudit, Log, All);
+
+Uparkour_GP4CollisionAuditCommandlet::Uparkour_GP4CollisionAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Audits the collision of the meshes traversal traces can hit and times the traversal queries against them.");
+	HelpUsage = TEXT("-run=parkour_GP4CollisionAudit -Map=/Game/_Parkour/Maps/ParkourMap [-Fix] [-Iterations=200] [-MaxConvexVertices=64] [-MinHullVolumeFraction=0.8]");
+	HelpParamNames = { TEXT("Fix"), TEXT("MinHullVolumeFraction") };
+	HelpParamDescriptions = {
+		TEXT("Replaces the simple collision of meshes that need it with a box or a convex hull. This changes the mesh assets, so the proxy applies to every collision channel, not just the traversal traces."),
+		TEXT("Meshes filling less of their convex hull than this are concave, like arches or pieces with gaps. -Fix only reports them, a single proxy would fill them in.")
+	};
+}
+
+int32 Uparkour_GP4CollisionAuditCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName = TEXT("/Game/_Parkour/Maps/ParkourMap");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("MaxConvexVertices="), MaxConvexVertices);
+	FParse::Value(*Params, TEXT("MinHullVolumeFraction="), MinHullVolumeFraction);
+	const bool bFix = FParse::Param(*Params, TEXT("Fix"));
+	if (bFix)
+	{
+		UE_LOG(LogParkourCollisionAudit, Display, TEXT("-Fix replaces the simple collision of the mesh assets, the proxies apply to every collision channel, not just the traversal traces"));
+	}
+
+	UWorld* World = ParkourCommandlet::LoadWorldForTraces(MapName);
+	if (World == nullptr)
+	{
+		UE_LOG(LogParkourCollisionAudit, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	// Same components the traversal link generation treats as obstacles, grouped by mesh.
+	TMap<UStaticMesh*, int32> AuditIndices;
+	TArray<FMeshAudit> Audits;
+	for (TObjectIterator<UStaticMeshComponent> It; It; ++It)
+	{
+		UStaticMesh* Mesh = It->GetStaticMesh();
+		if (It->GetWorld() != World || Mesh == nullptr || It->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+		{
+			continue;
+		}
+
+		int32& AuditIndex = AuditIndices.FindOrAdd(Mesh, INDEX_NONE);
+		if (AuditIndex == INDEX_NONE)
+		{
+			AuditIndex = Audits.AddDefaulted();
+			Audits[AuditIndex].Mesh = Mesh;
+		}
+		Audits[AuditIndex].Components.Add(*It);
+	}
+
+	for (FMeshAudit& Audit : Audits)
+	{
+		AuditMesh(Audit);
+		Audit.MicrosecondsPerQueryBefore = TimeQueries(World, Audit);
+	}
+
+	if (bFix)
+	{
+		for (FMeshAudit& Audit : Audits)
+		{
+			if (!Audit.bNeedsProxy || Audit.bConcave || !GenerateProxy(Audit))
+			{
+				continue;
+			}
+
+			for (UStaticMeshComponent* Component : Audit.Components)
+			{
+				Component->RecreatePhysicsState();
+			}
+			Audit.MicrosecondsPerQueryAfter = TimeQueries(World, Audit);
+
+			UPackage* Package = Audit.Mesh->GetOutermost();
+			const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+			FSavePackageArgs SaveArgs;
+			SaveArgs.TopLevelFlags = RF_Standalone;
+			if (!UPackage::SavePackage(Package, Audit.Mesh, *Filename, SaveArgs))
+			{
+				UE_LOG(LogParkourCollisionAudit, Error, TEXT("Could not save %s"), *Filename);
+			}
+		}
+	}
+
+	WriteReport(Audits);
+	ParkourCommandlet::UnloadWorld(World);
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+/// <summary>
+/// Counts what the traversal traces run against. They never trace complex, so a mesh needs simple collision,
+/// and complex as simple or a big convex hull makes every trace test the triangles or a large hull.
+/// </summary>
+void Uparkour_GP4CollisionAuditCommandlet::AuditMesh(FMeshAudit& Audit) const
+{
+	const FStaticMeshRenderData* RenderData = Audit.Mesh->GetRenderData();
+	if (RenderData && RenderData->LODResources.Num() > 0)
+	{
+		Audit.NumTriangles = RenderData->LODResources[0].GetNumTriangles();
+		Audit.HullVolumeFraction = GetHullVolumeFraction(RenderData->LODResources[0]);
+		Audit.bConcave = Audit.HullVolumeFraction < MinHullVolumeFraction;
+	}
+
+	const UBodySetup* BodySetup = Audit.Mesh->GetBodySetup();
+	if (BodySetup == nullptr)
+	{
+		return;
+	}
+
+	const FKAggregateGeom& AggGeom = BodySetup->AggGeom;
+	Audit.NumSimpleShapes = AggGeom.GetElementCount();
+	for (const FKConvexElem& ConvexElem : AggGeom.ConvexElems)
+	{
+		Audit.NumConvexVertices += ConvexElem.VertexData.Num();
+	}
+	Audit.bComplexAsSimple = BodySetup->CollisionTraceFlag == CTF_UseComplexAsSimple;
+
+	// Only project meshes can be changed, engine content is left alone.
+	Audit.bNeedsProxy = Audit.Mesh->GetPathName().StartsWith(TEXT("/Game/"))
+		&& (Audit.bComplexAsSimple || Audit.NumSimpleShapes == 0 || Audit.NumConvexVertices > MaxConvexVertices);
+}
+
+/// <summary>
+/// Volume of the mesh divided by the volume of the convex hull of its vertices. The mesh volume is summed from the signed volumes of its triangles,
+/// which only works for closed meshes, so open meshes come out as concave and are left for a person to look at.
+/// </summary>
+float Uparkour_GP4CollisionAuditCommandlet::GetHullVolumeFraction(const FStaticMeshLODResources& LODResources)
+{
+	const FPositionVertexBuffer& Positions = LODResources.VertexBuffers.PositionVertexBuffer;
+	if (Positions.GetNumVertices() < 4)
+	{
+		return 0.0f;
+	}
+
+	TArray<uint32> Indices;
+	LODResources.IndexBuffer.GetCopy(Indices);
+
+	double MeshVolume = 0.0;
+	for (int32 Index = 0; Index + 2 < Indices.Num(); Index += 3)
+	{
+		const FVector A(Positions.VertexPosition(Indices[Index]));
+		const FVector B(Positions.VertexPosition(Indices[Index + 1]));
+		const FVector C(Positions.VertexPosition(Indices[Index + 2]));
+		MeshVolume += FVector::DotProduct(A, FVector::CrossProduct(B, C)) / 6.0;
+	}
+
+	TArray<Chaos::FConvex::FVec3Type> HullVertices;
+	HullVertices.Reserve(Positions.GetNumVertices());
+	for (uint32 Index = 0; Index < Positions.GetNumVertices(); Index++)
+	{
+		HullVertices.Add(Positions.VertexPosition(Index));
+	}
+	const Chaos::FConvex Hull(MoveTemp(HullVertices), 0.0f);
+
+	const double HullVolume = Hull.GetVolume();
+	return HullVolume > UE_KINDA_SMALL_NUMBER ? FMath::Clamp(static_cast<float>(MeshVolume / HullVolume), 0.0f, 1.0f) : 0.0f;
+}
+
+/// <summary>
+/// Times the kind of queries the vault and mantle chains make against every instance of the mesh:
+/// line traces into each side at mid height and small sphere sweeps down onto the top.
+/// </summary>
+double Uparkour_GP4CollisionAuditCommandlet::TimeQueries(UWorld* World, const FMeshAudit& Audit) const
+{
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ParkourCollisionAudit), false);
+	const FCollisionShape Sphere = FCollisionShape::MakeSphere(10.0f);
+	const FVector Sides[] = { FVector::ForwardVector, -FVector::ForwardVector, FVector::RightVector, -FVector::RightVector };
+
+	int64 NumQueries = 0;
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		for (const UStaticMeshComponent* Component : Audit.Components)
+		{
+			const FBox Box = Component->Bounds.GetBox();
+			const FVector Center = Box.GetCenter();
+			const FVector Extent = Box.GetExtent();
+
+			for (const FVector& Side : Sides)
+			{
+				FHitResult Hit;
+				const FVector Start = Center + Side * (Extent.GetMax() + 100.0f);
+				World->LineTraceSingleByChannel(Hit, Start, Center, ECC_Visibility, QueryParams);
+
+				const FVector SweepEnd(Center.X + Side.X * Extent.X * 0.5f, Center.Y + Side.Y * Extent.Y * 0.5f, Box.Max.Z);
+				World->SweepSingleByChannel(Hit, SweepEnd + FVector(0.0f, 0.0f, 100.0f), SweepEnd, FQuat::Identity, ECC_Visibility, Sphere, QueryParams);
+				NumQueries += 2;
+			}
+		}
+	}
+
+	const double Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	return NumQueries ? Seconds * 1000000.0 / NumQueries : 0.0;
+}
+
+/// <summary>
+/// Replaces the simple collision of the mesh with a box if the mesh fills its bounds, otherwise with one convex hull
+/// welded down to MaxConvexVertices, and makes the traces use it. Only called for meshes that nearly fill their hull.
+/// </summary>
+bool Uparkour_GP4CollisionAuditCommandlet::GenerateProxy(FMeshAudit& Audit) const
+{
+#if WITH_EDITOR
+	UStaticMesh* Mesh = Audit.Mesh;
+	UBodySetup* BodySetup = Mesh->GetBodySetup();
+	const FStaticMeshRenderData* RenderData = Mesh->GetRenderData();
+	if (BodySetup == nullptr || RenderData == nullptr || RenderData->LODResources.Num() == 0)
+	{
+		return false;
+	}
+
+	const FPositionVertexBuffer& Positions = RenderData->LODResources[0].VertexBuffers.PositionVertexBuffer;
+	const FBox Bounds = Mesh->GetBoundingBox();
+	const FVector Size = Bounds.GetSize();
+
+	// A box only fits if every corner of the bounds has a vertex near it, chamfered cubes pass, ramps and cylinders do not.
+	const float CornerTolerance = Size.GetMin() * BoxCornerTolerance;
+	bool bBoxFits = true;
+	for (int32 Corner = 0; Corner < 8 && bBoxFits; Corner++)
+	{
+		const FVector CornerLocation((Corner & 1) ? Bounds.Max.X : Bounds.Min.X, (Corner & 2) ? Bounds.Max.Y : Bounds.Min.Y, (Corner & 4) ? Bounds.Max.Z : Bounds.Min.Z);
+		bool bCovered = false;
+		for (uint32 Index = 0; Index < Positions.GetNumVertices() && !bCovered; Index++)
+		{
+			bCovered = FVector::DistSquared(FVector(Positions.VertexPosition(Index)), CornerLocation) <= FMath::Square(CornerTolerance);
+		}
+		bBoxFits = bCovered;
+	}
+
+	Mesh->Modify();
+	BodySetup->Modify();
+	BodySetup->RemoveSimpleCollision();
+
+	if (bBoxFits)
+	{
+		FKBoxElem BoxElem(Size.X, Size.Y, Size.Z);
+		BoxElem.Center = Bounds.GetCenter();
+		BodySetup->AggGeom.BoxElems.Add(BoxElem);
+		Audit.GeneratedProxy = TEXT("Box");
+	}
+	else
+	{
+		// Weld the vertices on a grid that gets coarser until the hull is small enough.
+		TArray<FVector> HullVertices;
+		float GridSize = Size.GetMax() / 64.0f;
+		do
+		{
+			TSet<FIntVector> Cells;
+			HullVertices.Reset();
+			for (uint32 Index = 0; Index < Positions.GetNumVertices(); Index++)
+			{
+				const FVector Vertex(Positions.VertexPosition(Index));
+				const FIntVector Cell(FMath::RoundToInt(Vertex.X / GridSize), FMath::RoundToInt(Vertex.Y / GridSize), FMath::RoundToInt(Vertex.Z / GridSize));
+				bool bAlreadyInSet = false;
+				Cells.Add(Cell, &bAlreadyInSet);
+				if (!bAlreadyInSet)
+				{
+					HullVertices.Add(FVector(Cell) * GridSize);
+				}
+			}
+			GridSize *= 2.0f;
+		}
+		while (HullVertices.Num() > MaxConvexVertices && GridSize < Size.GetMax());
+
+		FKConvexElem ConvexElem;
+		ConvexElem.VertexData = MoveTemp(HullVertices);
+		ConvexElem.UpdateElemBox();
+		BodySetup->AggGeom.ConvexElems.Add(ConvexElem);
+		Audit.GeneratedProxy = FString::Printf(TEXT("Convex%d"), ConvexElem.VertexData.Num());
+	}
+
+	BodySetup->CollisionTraceFlag = CTF_UseDefault;
+	BodySetup->InvalidatePhysicsData();
+	BodySetup->CreatePhysicsMeshes();
+	Mesh->MarkPackageDirty();
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Uparkour_GP4CollisionAuditCommandlet::WriteReport(const TArray<FMeshAudit>& Audits) const
+{
+	FString Csv = TEXT("Mesh,Instances,Triangles,SimpleShapes,ConvexVertices,ComplexAsSimple,HullVolumeFraction,GeneratedProxy,UsPerQueryBefore,UsPerQueryAfter\n");
+
+	for (const FMeshAudit& Audit : Audits)
+	{
+		UE_LOG(LogParkourCollisionAudit, Display, TEXT("%s: %d instances, %d triangles, %d simple shapes, %d convex vertices%s, %.3f us per query%s"),
+			*Audit.Mesh->GetName(), Audit.Components.Num(), Audit.NumTriangles, Audit.NumSimpleShapes, Audit.NumConvexVertices,
+			Audit.bComplexAsSimple ? TEXT(", complex as simple") : TEXT(""), Audit.MicrosecondsPerQueryBefore,
+			Audit.GeneratedProxy.IsEmpty() ? TEXT("") : *FString::Printf(TEXT(" -> %s, %.3f us per query"), *Audit.GeneratedProxy, Audit.MicrosecondsPerQueryAfter));
+
+		if (Audit.bNeedsProxy && Audit.bConcave)
+		{
+			UE_LOG(LogParkourCollisionAudit, Warning, TEXT("%s needs simplified collision for traversal traces but only fills %.0f%% of its convex hull, author its collision by hand"),
+				*Audit.Mesh->GetName(), Audit.HullVolumeFraction * 100.0f);
+		}
+		else if (Audit.bNeedsProxy && Audit.GeneratedProxy.IsEmpty())
+		{
+			UE_LOG(LogParkourCollisionAudit, Warning, TEXT("%s needs simplified collision for traversal traces, run with -Fix"), *Audit.Mesh->GetName());
+		}
+
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%.3f,%s,%.4f,%.4f\n"), *Audit.Mesh->GetPathName(), Audit.Components.Num(), Audit.NumTriangles,
+			Audit.NumSimpleShapes, Audit.NumConvexVertices, Audit.bComplexAsSimple ? 1 : 0, Audit.HullVolumeFraction, *Audit.GeneratedProxy,
+			Audit.MicrosecondsPerQueryBefore, Audit.MicrosecondsPerQueryAfter);
+	}
+
+	const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("CollisionAudit.csv");
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogParkourCollisionAudit, Display, TEXT("Wrote %s"), *CsvPath);
+	}
+}
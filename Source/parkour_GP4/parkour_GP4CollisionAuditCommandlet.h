@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "parkour_GP4CollisionAuditCommandlet.generated.h"
+
+class UStaticMesh;
+class UStaticMeshComponent;
+struct FStaticMeshLODResources;
+
+/**
+ * Audits the collision of every static mesh the traversal traces can hit in a map and times the traversal queries against it.
+ *
+ * UnrealEditor-Cmd parkour_GP4.uproject -run=parkour_GP4CollisionAudit -Map=/Game/_Parkour/Maps/ParkourMap [-Fix] [-Iterations=200] [-MinHullVolumeFraction=0.8]
+ *
+ * With -Fix, meshes without simple collision or using their complex collision as simple get a box, or a convex hull
+ * if the mesh does not fill its bounds, and the queries are timed again. The results go to Saved/Profiling/CollisionAudit.csv.
+ *
+ * The proxy replaces the simple collision of the mesh asset, so it applies to every channel and every instance, not just the traversal traces.
+ * Concave meshes, like arches or pieces with gaps, are only reported. A single proxy would fill them in and change which vaults are possible.
+ */
+UCLASS()
+class Uparkour_GP4CollisionAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	Uparkour_GP4CollisionAuditCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FMeshAudit
+	{
+		UStaticMesh* Mesh = nullptr;
+		TArray<UStaticMeshComponent*> Components;
+		int32 NumTriangles = 0;
+		int32 NumSimpleShapes = 0;
+		int32 NumConvexVertices = 0;
+		bool bComplexAsSimple = false;
+		bool bNeedsProxy = false;
+		/** Volume of the mesh as a fraction of the volume of its convex hull, 1 for convex meshes. */
+		float HullVolumeFraction = 1.0f;
+		/** Fills too little of its hull for a single proxy, so -Fix leaves it alone. */
+		bool bConcave = false;
+		FString GeneratedProxy;
+		double MicrosecondsPerQueryBefore = 0.0;
+		double MicrosecondsPerQueryAfter = 0.0;
+	};
+
+	void AuditMesh(FMeshAudit& Audit) const;
+	static float GetHullVolumeFraction(const FStaticMeshLODResources& LODResources);
+	double TimeQueries(UWorld* World, const FMeshAudit& Audit) const;
+	bool GenerateProxy(FMeshAudit& Audit) const;
+	void WriteReport(const TArray<FMeshAudit>& Audits) const;
+
+	int32 Iterations = 200;
+
+	/** Convex hulls with more vertices than this are treated as badly proxied. */
+	int32 MaxConvexVertices = 64;
+
+	/** A box replaces the mesh if it has a vertex this close to every corner of its bounds, as a fraction of the smallest bounds size. */
+	float BoxCornerTolerance = 0.1f;
+
+	/** Meshes filling less than this fraction of their convex hull are concave and get no proxy. */
+	float MinHullVolumeFraction = 0.8f;
+};
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4CommandletWorld.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+#if WITH_EDITOR
+UWorld* ParkourCommandlet::LoadWorldForTraces(const FString& MapName)
+{
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	// The map is only loaded, it needs a physics scene for the traces.
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		UWorld::InitializationValues InitValues;
+		InitValues.RequiresHitProxies(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true);
+		World->InitWorld(InitValues);
+	}
+	World->UpdateWorldComponents(true, false);
+
+	return World;
+}
+
+bool ParkourCommandlet::SaveWorld(UWorld* World)
+{
+	UPackage* Package = World->GetOutermost();
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetMapPackageExtension());
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Standalone;
+	return UPackage::SavePackage(Package, World, *Filename, SaveArgs);
+}
+
+void ParkourCommandlet::UnloadWorld(UWorld* World)
+{
+	World->RemoveFromRoot();
+	World->DestroyWorld(false);
+}
+#endif
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/** Loading a map in a commandlet so traces can run against it. */
+namespace ParkourCommandlet
+{
+#if WITH_EDITOR
+	/** Loads the map and gives it a physics scene. Returns null if the map could not be loaded. */
+	UWorld* LoadWorldForTraces(const FString& MapName);
+
+	/** Saves the map package of a world loaded with LoadWorldForTraces. */
+	bool SaveWorld(UWorld* World);
+
+	void UnloadWorld(UWorld* World);
+#endif
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4Course.h"
+#include "parkour_GP4NetRate.h"
+#include "Components/SplineComponent.h"
+#include "Engine/World.h"
+
+Aparkour_GP4Course::Aparkour_GP4Course()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Spline = CreateDefaultSubobject<USplineComponent>(TEXT("Course"));
+	RootComponent = Spline;
+}
+
+void Aparkour_GP4Course::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Uparkour_GP4NetRateSubsystem* NetRate = GetWorld()->GetSubsystem<Uparkour_GP4NetRateSubsystem>();
+	if (NetRate && (bReplaceExistingCourse || !NetRate->HasCourse()))
+	{
+		NetRate->SetCourse(this);
+	}
+}
+
+void Aparkour_GP4Course::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Uparkour_GP4NetRateSubsystem* NetRate = GetWorld()->GetSubsystem<Uparkour_GP4NetRateSubsystem>())
+	{
+		NetRate->ClearCourse(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+float Aparkour_GP4Course::GetDistanceAlongCourse(const FVector& Location) const
+{
+	const float InputKey = Spline->FindInputKeyClosestToWorldLocation(Location);
+	return Spline->GetDistanceAlongSplineAtSplineInputKey(InputKey);
+}
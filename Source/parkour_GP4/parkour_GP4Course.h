@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "parkour_GP4Course.generated.h"
+
+class USplineComponent;
+
+/**
+ * The line a course is run along, from start to finish. Place one per map and lay the spline through the obstacles.
+ * The server uses the distance along it to stop replicating characters that are far ahead or behind on the course,
+ * even when the course doubles back and they are close in a straight line.
+ */
+UCLASS()
+class Aparkour_GP4Course : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	Aparkour_GP4Course();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Distance from the start of the course to the point on it closest to Location. */
+	float GetDistanceAlongCourse(const FVector& Location) const;
+
+	USplineComponent* GetSpline() const { return Spline; }
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = Course)
+		USplineComponent* Spline;
+
+	/** If this course takes over from a course that began play before it. Otherwise it is only used while the map has no other course. */
+	UPROPERTY(EditAnywhere, Category = Course)
+		bool bReplaceExistingCourse = true;
+};
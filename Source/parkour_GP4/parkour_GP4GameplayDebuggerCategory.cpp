@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4GameplayDebuggerCategory.h"
+
+#if WITH_GAMEPLAY_DEBUGGER
+
+#include "parkour_GP4Character.h"
+#include "parkour_GP4TraversalDebug.h"
+
+FGameplayDebuggerCategory_Parkour::FGameplayDebuggerCategory_Parkour()
+{
+	SetDataPackReplication<FRepData>(&DataPack);
+}
+
+TSharedRef<FGameplayDebuggerCategory> FGameplayDebuggerCategory_Parkour::MakeInstance()
+{
+	return MakeShareable(new FGameplayDebuggerCategory_Parkour());
+}
+
+void FGameplayDebuggerCategory_Parkour::FRepData::Serialize(FArchive& Ar)
+{
+	Ar << CharacterName;
+	Ar << bIsSliding;
+	Ar << bIsSprinting;
+	Ar << bCanVault;
+	Ar << VaultDistance;
+	Ar << bCanMantle;
+	Ar << NumQueries;
+}
+
+void FGameplayDebuggerCategory_Parkour::CollectData(APlayerController* OwnerPC, AActor* DebugActor)
+{
+	Aparkour_GP4Character* Character = Cast<Aparkour_GP4Character>(DebugActor);
+	if (Character == nullptr)
+	{
+		DataPack = FRepData();
+		return;
+	}
+
+	// Data is collected every frame while the category is shown, so recording stops shortly after it is hidden or another actor is picked.
+	Character->RecordTraversalQueriesFor(1.0f);
+
+	DataPack.CharacterName = Character->GetName();
+	DataPack.bIsSliding = Character->IsSliding;
+	DataPack.bIsSprinting = Character->IsSprinting;
+	DataPack.bCanVault = Character->CanVault;
+	DataPack.VaultDistance = Character->VaultDistance;
+	DataPack.bCanMantle = Character->CanMantle;
+
+	const FParkourTraversalQueryHistory& History = Character->GetTraversalQueryHistory();
+	DataPack.NumQueries = History.GetNum();
+
+	History.ForEach([this](const FParkourTraversalQueryRecord& Record)
+	{
+		const FColor Color = Record.bHit ? FColor::Red : FColor::Green;
+		const FString Description = Record.QueryName.ToString();
+
+		switch (Record.Shape)
+		{
+		case EParkourTraversalQueryShape::Line:
+			AddShape(FGameplayDebuggerShape::MakeSegment(Record.Start, Record.End, 2.0f, Color, Description));
+			break;
+		case EParkourTraversalQueryShape::Sphere:
+			AddShape(FGameplayDebuggerShape::MakePoint(Record.Start, Record.Radius, Color, Description));
+			if (!Record.Start.Equals(Record.End))
+			{
+				AddShape(FGameplayDebuggerShape::MakeSegment(Record.Start, Record.End, 1.0f, Color));
+				AddShape(FGameplayDebuggerShape::MakePoint(Record.End, Record.Radius, Color));
+			}
+			break;
+		case EParkourTraversalQueryShape::Capsule:
+			AddShape(FGameplayDebuggerShape::MakeCapsule(Record.Start, Record.Radius, Record.HalfHeight, Color, Description));
+			break;
+		case EParkourTraversalQueryShape::Box:
+			AddShape(FGameplayDebuggerShape::MakeBox(Record.Start, Record.Extent, Color, Description));
+			break;
+		}
+
+		if (Record.bHit && Record.Shape != EParkourTraversalQueryShape::Box)
+		{
+			AddShape(FGameplayDebuggerShape::MakePoint(Record.ImpactPoint, 4.0f, FColor::Yellow));
+		}
+	});
+}
+
+void FGameplayDebuggerCategory_Parkour::DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext)
+{
+	if (DataPack.CharacterName.IsEmpty())
+	{
+		CanvasContext.Printf(TEXT("{red}Selected actor is not a parkour character"));
+		return;
+	}
+
+	CanvasContext.Printf(TEXT("Character: {yellow}%s"), *DataPack.CharacterName);
+	CanvasContext.Printf(TEXT("Sliding: {yellow}%s{white}  Sprinting: {yellow}%s"),
+		DataPack.bIsSliding ? TEXT("true") : TEXT("false"),
+		DataPack.bIsSprinting ? TEXT("true") : TEXT("false"));
+	CanvasContext.Printf(TEXT("CanVault: {yellow}%s{white}  VaultDistance: {yellow}%d{white}  CanMantle: {yellow}%s"),
+		DataPack.bCanVault ? TEXT("true") : TEXT("false"),
+		DataPack.VaultDistance,
+		DataPack.bCanMantle ? TEXT("true") : TEXT("false"));
+	CanvasContext.Printf(TEXT("Recorded queries: {yellow}%d{white} (hit {red}red{white}, miss {green}green{white})"), DataPack.NumQueries);
+}
+
+#endif // WITH_GAMEPLAY_DEBUGGER
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_GAMEPLAY_DEBUGGER
+
+#include "GameplayDebuggerCategory.h"
+
+class APlayerController;
+class AActor;
+
+/**
+ * Gameplay debugger category showing the traversal state and the last traversal queries of the selected parkour character.
+ * Only the selected character records its queries, and only while the category is active.
+ */
+class FGameplayDebuggerCategory_Parkour : public FGameplayDebuggerCategory
+{
+public:
+	FGameplayDebuggerCategory_Parkour();
+
+	virtual void CollectData(APlayerController* OwnerPC, AActor* DebugActor) override;
+	virtual void DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext) override;
+
+	static TSharedRef<FGameplayDebuggerCategory> MakeInstance();
+
+protected:
+	struct FRepData
+	{
+		FString CharacterName;
+		bool bIsSliding = false;
+		bool bIsSprinting = false;
+		bool bCanVault = false;
+		int32 VaultDistance = 0;
+		bool bCanMantle = false;
+		int32 NumQueries = 0;
+
+		void Serialize(FArchive& Ar);
+	};
+	FRepData DataPack;
+};
+
+#endif // WITH_GAMEPLAY_DEBUGGER
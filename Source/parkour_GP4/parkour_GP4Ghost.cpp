@@ -0,0 +1,680 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4Ghost.h"
+#include "Animation/AnimSequence.h"
+#include "Async/MappedFileHandle.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<int32> CVarGhostSampleRate(
+	TEXT("parkour.Ghost.SampleRate"),
+	30,
+	TEXT("Samples per second written to new ghost recordings."));
+
+static TAutoConsoleVariable<float> CVarGhostPositionQuantum(
+	TEXT("parkour.Ghost.PositionQuantum"),
+	0.5f,
+	TEXT("Position precision in cm of new ghost recordings."));
+
+static void WriteVarUInt(TArray<uint8>& Buffer, uint32 Value)
+{
+	while (Value >= 0x80)
+	{
+		Buffer.Add(uint8(Value | 0x80));
+		Value >>= 7;
+	}
+	Buffer.Add(uint8(Value));
+}
+
+static void WriteVarInt(TArray<uint8>& Buffer, int32 Value)
+{
+	// Zigzag so small negative deltas stay small.
+	WriteVarUInt(Buffer, (uint32(Value) << 1) ^ uint32(Value >> 31));
+}
+
+static bool ReadVarUInt(const uint8* Data, int64 Size, int64& Cursor, uint32& OutValue)
+{
+	OutValue = 0;
+	for (int32 Shift = 0; Shift < 35; Shift += 7)
+	{
+		if (Cursor >= Size)
+		{
+			return false;
+		}
+
+		const uint8 Byte = Data[Cursor++];
+		OutValue |= uint32(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ReadVarInt(const uint8* Data, int64 Size, int64& Cursor, int32& OutValue)
+{
+	uint32 Raw;
+	if (!ReadVarUInt(Data, Size, Cursor, Raw))
+	{
+		return false;
+	}
+
+	OutValue = int32(Raw >> 1) ^ -int32(Raw & 1);
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FParkourGhostRun
+
+FParkourGhostRun::~FParkourGhostRun()
+{
+	// The region has to go before the file it maps.
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+TSharedPtr<FParkourGhostRun> FParkourGhostRun::Open(const FString& Filename)
+{
+	TSharedPtr<FParkourGhostRun> Run = MakeShared<FParkourGhostRun>();
+
+	Run->MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!Run->MappedFile.IsValid() || Run->MappedFile->GetFileSize() < ParkourGhostFormat::HeaderSize)
+	{
+		return nullptr;
+	}
+
+	Run->MappedRegion.Reset(Run->MappedFile->MapRegion(0, Run->MappedFile->GetFileSize()));
+	if (!Run->MappedRegion.IsValid())
+	{
+		return nullptr;
+	}
+
+	Run->Data = Run->MappedRegion->GetMappedPtr();
+	Run->Size = Run->MappedRegion->GetMappedSize();
+
+	uint32 Magic;
+	uint16 Version;
+	FMemory::Memcpy(&Magic, Run->Data, sizeof(Magic));
+	FMemory::Memcpy(&Version, Run->Data + 4, sizeof(Version));
+	FMemory::Memcpy(&Run->SampleRate, Run->Data + 6, sizeof(Run->SampleRate));
+	FMemory::Memcpy(&Run->PositionQuantum, Run->Data + 8, sizeof(Run->PositionQuantum));
+
+	if (Magic != ParkourGhostFormat::Magic || Version != ParkourGhostFormat::Version || Run->SampleRate == 0)
+	{
+		return nullptr;
+	}
+
+	return Run;
+}
+
+bool FParkourGhostRun::ReadSample(int64& Cursor, FParkourGhostSample& InOutSample, TArray<FParkourGhostEventRecord, TInlineAllocator<ParkourGhostFormat::MaxEventsPerSample>>& OutEvents) const
+{
+	int64 Position = Cursor;
+	if (Position >= Size)
+	{
+		return false;
+	}
+
+	const uint8 Tag = Data[Position++];
+	FParkourGhostSample Sample = (Tag & ParkourGhostFormat::KeyframeFlag) ? FParkourGhostSample() : InOutSample;
+
+	int32 Values[5];
+	for (int32& Value : Values)
+	{
+		if (!ReadVarInt(Data, Size, Position, Value))
+		{
+			return false;
+		}
+	}
+
+	Sample.Position[0] += Values[0];
+	Sample.Position[1] += Values[1];
+	Sample.Position[2] += Values[2];
+	Sample.Yaw = (Sample.Yaw + Values[3]) & 0xFFFF;
+	Sample.Speed += Values[4];
+
+	OutEvents.Reset();
+	const int32 NumEvents = Tag & ParkourGhostFormat::EventCountMask;
+	for (int32 EventIndex = 0; EventIndex < NumEvents; EventIndex++)
+	{
+		if (Position >= Size)
+		{
+			return false;
+		}
+
+		FParkourGhostEventRecord& EventRecord = OutEvents.AddDefaulted_GetRef();
+		EventRecord.Event = static_cast<EParkourTraversalEvent>(Data[Position++]);
+		if (EventRecord.Event == EParkourTraversalEvent::Vault)
+		{
+			uint32 VaultDistance;
+			if (!ReadVarUInt(Data, Size, Position, VaultDistance))
+			{
+				return false;
+			}
+			EventRecord.VaultDistance = VaultDistance;
+		}
+	}
+
+	InOutSample = Sample;
+	Cursor = Position;
+	return true;
+}
+
+FVector FParkourGhostRun::GetLocation(const FParkourGhostSample& Sample) const
+{
+	return FVector(Sample.Position[0], Sample.Position[1], Sample.Position[2]) * PositionQuantum;
+}
+
+float FParkourGhostRun::GetYaw(const FParkourGhostSample& Sample) const
+{
+	return FRotator::DecompressAxisFromShort(uint16(Sample.Yaw));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Aparkour_GP4Ghost
+
+Aparkour_GP4Ghost::Aparkour_GP4Ghost()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Mesh"));
+	RootComponent = Mesh;
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetGenerateOverlapEvents(false);
+	Mesh->SetCastShadow(false);
+	Mesh->AnimationMode = EAnimationMode::AnimationSingleNode;
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	Mesh->bEnableUpdateRateOptimizations = true;
+}
+
+void Aparkour_GP4Ghost::SetLocomotionSpeed(float Speed)
+{
+	if (bSliding || GetWorld()->GetTimeSeconds() < EventAnimationEndTime)
+	{
+		return;
+	}
+
+	const bool bRunning = Speed > 10.0f;
+	PlayLooping(bRunning ? RunAnimation : IdleAnimation);
+	Mesh->SetPlayRate(bRunning && RunAnimationSpeed > 0.0f ? Speed / RunAnimationSpeed : 1.0f);
+}
+
+void Aparkour_GP4Ghost::PlayGhostEvent(EParkourTraversalEvent Event, int32 VaultDistance)
+{
+	UAnimSequence* Animation = nullptr;
+	switch (Event)
+	{
+	case EParkourTraversalEvent::SlideStart:
+		Animation = SlideAnimation;
+		bSliding = true;
+		break;
+	case EParkourTraversalEvent::SlideEnd:
+		bSliding = false;
+		EventAnimationEndTime = 0.0;
+		break;
+	case EParkourTraversalEvent::Vault:
+		Animation = VaultAnimation;
+		break;
+	case EParkourTraversalEvent::Mantle:
+		Animation = MantleAnimation;
+		break;
+	case EParkourTraversalEvent::SprintStop:
+		Animation = RunToStopAnimation;
+		break;
+	}
+
+	if (Animation)
+	{
+		const bool bLoop = Event == EParkourTraversalEvent::SlideStart;
+		Mesh->PlayAnimation(Animation, bLoop);
+		Mesh->SetPlayRate(1.0f);
+		CurrentLoop = bLoop ? Animation : nullptr;
+		EventAnimationEndTime = GetWorld()->GetTimeSeconds() + Animation->GetPlayLength();
+	}
+
+	OnGhostEvent(Event, VaultDistance);
+}
+
+void Aparkour_GP4Ghost::PlayLooping(UAnimSequence* Animation)
+{
+	if (Animation && Animation != CurrentLoop)
+	{
+		Mesh->PlayAnimation(Animation, true);
+		CurrentLoop = Animation;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Uparkour_GP4GhostSubsystem
+
+bool Uparkour_GP4GhostSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void Uparkour_GP4GhostSubsystem::Deinitialize()
+{
+	StopRecording();
+	Playbacks.Reset();
+
+	Super::Deinitialize();
+}
+
+FString Uparkour_GP4GhostSubsystem::GetGhostFilename(const FString& Name)
+{
+	return FPaths::ProjectSavedDir() / TEXT("Ghosts") / Name + TEXT(".pkghost");
+}
+
+void Uparkour_GP4GhostSubsystem::RecordEvent(const AActor* Character, EParkourTraversalEvent Event, int32 VaultDistance)
+{
+	const UWorld* World = Character ? Character->GetWorld() : nullptr;
+	Uparkour_GP4GhostSubsystem* Subsystem = World ? World->GetSubsystem<Uparkour_GP4GhostSubsystem>() : nullptr;
+	if (Subsystem && Subsystem->Recording && Subsystem->Recording->Character.Get() == Character)
+	{
+		FParkourGhostEventRecord& EventRecord = Subsystem->Recording->PendingEvents.AddDefaulted_GetRef();
+		EventRecord.Event = Event;
+		EventRecord.VaultDistance = VaultDistance;
+	}
+}
+
+bool Uparkour_GP4GhostSubsystem::StartRecording(const ACharacter* Character, const FString& Name)
+{
+	StopRecording();
+
+	const FString Filename = GetGhostFilename(Name);
+	FArchive* File = IFileManager::Get().CreateFileWriter(*Filename);
+	if (Character == nullptr || File == nullptr)
+	{
+		delete File;
+		UE_LOG(LogTemp, Error, TEXT("Could not record a ghost to %s"), *Filename);
+		return false;
+	}
+
+	Recording = MakeUnique<FRecording>();
+	Recording->Character = Character;
+	Recording->File.Reset(File);
+	Recording->SampleRate = FMath::Clamp(CVarGhostSampleRate.GetValueOnGameThread(), 1, 120);
+	Recording->PositionQuantum = FMath::Max(CVarGhostPositionQuantum.GetValueOnGameThread(), 0.01f);
+
+	const uint32 Magic = ParkourGhostFormat::Magic;
+	const uint16 Version = ParkourGhostFormat::Version;
+	const uint16 SampleRate = uint16(Recording->SampleRate);
+	Recording->Buffer.AddUninitialized(ParkourGhostFormat::HeaderSize);
+	uint8* Header = Recording->Buffer.GetData();
+	FMemory::Memcpy(Header, &Magic, sizeof(Magic));
+	FMemory::Memcpy(Header + 4, &Version, sizeof(Version));
+	FMemory::Memcpy(Header + 6, &SampleRate, sizeof(SampleRate));
+	FMemory::Memcpy(Header + 8, &Recording->PositionQuantum, sizeof(Recording->PositionQuantum));
+	FlushRecording();
+
+	UE_LOG(LogTemp, Display, TEXT("Recording ghost to %s"), *Filename);
+	return true;
+}
+
+void Uparkour_GP4GhostSubsystem::StopRecording()
+{
+	if (!Recording)
+	{
+		return;
+	}
+
+	FlushRecording();
+	const int64 FileSize = Recording->File->TotalSize();
+	Recording->File->Close();
+
+	UE_LOG(LogTemp, Display, TEXT("Recorded ghost: %lld samples, %lld bytes, %.1f bytes per second"),
+		Recording->NumSamples, FileSize, Recording->NumSamples ? double(FileSize) * Recording->SampleRate / Recording->NumSamples : 0.0);
+	Recording.Reset();
+}
+
+/// <summary>
+/// Writes one sample of the recorded character's mesh transform and speed, along with any traversal events since the last sample.
+/// Every SampleRate samples a keyframe is written and the buffer goes to disk.
+/// </summary>
+void Uparkour_GP4GhostSubsystem::RecordSample()
+{
+	const ACharacter* Character = Recording->Character.Get();
+	if (Character == nullptr)
+	{
+		StopRecording();
+		return;
+	}
+
+	const USkeletalMeshComponent* CharacterMesh = Character->GetMesh();
+	const FVector Location = CharacterMesh->GetComponentLocation();
+
+	FParkourGhostSample Sample;
+	Sample.Position[0] = FMath::RoundToInt(Location.X / Recording->PositionQuantum);
+	Sample.Position[1] = FMath::RoundToInt(Location.Y / Recording->PositionQuantum);
+	Sample.Position[2] = FMath::RoundToInt(Location.Z / Recording->PositionQuantum);
+	Sample.Yaw = FRotator::CompressAxisToShort(CharacterMesh->GetComponentRotation().Yaw);
+	Sample.Speed = FMath::RoundToInt(Character->GetVelocity().Size2D());
+
+	const bool bKeyframe = Recording->SamplesSinceKeyframe == 0;
+	const FParkourGhostSample Base = bKeyframe ? FParkourGhostSample() : Recording->LastSample;
+	const int32 NumEvents = FMath::Min(Recording->PendingEvents.Num(), ParkourGhostFormat::MaxEventsPerSample);
+
+	TArray<uint8>& Buffer = Recording->Buffer;
+	Buffer.Add(uint8(NumEvents) | (bKeyframe ? ParkourGhostFormat::KeyframeFlag : 0));
+	WriteVarInt(Buffer, Sample.Position[0] - Base.Position[0]);
+	WriteVarInt(Buffer, Sample.Position[1] - Base.Position[1]);
+	WriteVarInt(Buffer, Sample.Position[2] - Base.Position[2]);
+	WriteVarInt(Buffer, int16(uint16(Sample.Yaw - Base.Yaw)));
+	WriteVarInt(Buffer, Sample.Speed - Base.Speed);
+
+	for (int32 EventIndex = 0; EventIndex < NumEvents; EventIndex++)
+	{
+		const FParkourGhostEventRecord& EventRecord = Recording->PendingEvents[EventIndex];
+		Buffer.Add(uint8(EventRecord.Event));
+		if (EventRecord.Event == EParkourTraversalEvent::Vault)
+		{
+			WriteVarUInt(Buffer, uint32(FMath::Max(EventRecord.VaultDistance, 0)));
+		}
+	}
+	Recording->PendingEvents.RemoveAt(0, NumEvents, false);
+
+	Recording->LastSample = Sample;
+	Recording->NumSamples++;
+	Recording->SamplesSinceKeyframe = (Recording->SamplesSinceKeyframe + 1) % Recording->SampleRate;
+	if (Recording->SamplesSinceKeyframe == 0)
+	{
+		FlushRecording();
+	}
+}
+
+void Uparkour_GP4GhostSubsystem::FlushRecording()
+{
+	Recording->File->Serialize(Recording->Buffer.GetData(), Recording->Buffer.Num());
+	Recording->File->Flush();
+	Recording->Buffer.Reset();
+}
+
+int32 Uparkour_GP4GhostSubsystem::Play(const FString& Name, int32 Count, float Spacing)
+{
+	const FString Filename = GetGhostFilename(Name);
+	TSharedPtr<FParkourGhostRun> Run = OpenRuns.FindRef(Filename).Pin();
+	if (!Run.IsValid())
+	{
+		Run = FParkourGhostRun::Open(Filename);
+		if (!Run.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Could not open ghost run %s"), *Filename);
+			return 0;
+		}
+		OpenRuns.Add(Filename, Run);
+	}
+
+	UClass* Class = GhostClass.LoadSynchronous();
+	if (Class == nullptr)
+	{
+		Class = Aparkour_GP4Ghost::StaticClass();
+	}
+
+	TArray<FParkourGhostEventRecord, TInlineAllocator<ParkourGhostFormat::MaxEventsPerSample>> SkippedEvents;
+	int32 NumStarted = 0;
+	for (int32 GhostIndex = 0; GhostIndex < Count; GhostIndex++)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		Aparkour_GP4Ghost* Ghost = GetWorld()->SpawnActor<Aparkour_GP4Ghost>(Class, FTransform::Identity, SpawnParams);
+		if (Ghost == nullptr)
+		{
+			continue;
+		}
+
+		FPlayback& Playback = Playbacks.AddDefaulted_GetRef();
+		Playback.Run = Run;
+		Playback.Ghost = Ghost;
+		RestartPlayback(Playback);
+
+		// Spread the ghosts along the run by starting each one further in.
+		const int32 SamplesToSkip = FMath::RoundToInt(GhostIndex * Spacing * Run->SampleRate);
+		for (int32 SampleIndex = 0; SampleIndex < SamplesToSkip; SampleIndex++)
+		{
+			Playback.Previous = Playback.Next;
+			if (!Run->ReadSample(Playback.Cursor, Playback.Next, SkippedEvents))
+			{
+				RestartPlayback(Playback);
+				break;
+			}
+		}
+		NumStarted++;
+	}
+
+	return NumStarted;
+}
+
+void Uparkour_GP4GhostSubsystem::StopAll()
+{
+	for (const FPlayback& Playback : Playbacks)
+	{
+		if (Aparkour_GP4Ghost* Ghost = Playback.Ghost.Get())
+		{
+			Ghost->Destroy();
+		}
+	}
+	Playbacks.Reset();
+	BenchmarkTimeLeft = 0.0f;
+}
+
+void Uparkour_GP4GhostSubsystem::RestartPlayback(FPlayback& Playback)
+{
+	TArray<FParkourGhostEventRecord, TInlineAllocator<ParkourGhostFormat::MaxEventsPerSample>> Events;
+
+	Playback.Cursor = ParkourGhostFormat::HeaderSize;
+	Playback.Next = FParkourGhostSample();
+	Playback.Run->ReadSample(Playback.Cursor, Playback.Next, Events);
+	Playback.Previous = Playback.Next;
+	Playback.Time = 0.0f;
+}
+
+void Uparkour_GP4GhostSubsystem::TickPlayback(FPlayback& Playback, float DeltaTime)
+{
+	const FParkourGhostRun& Run = *Playback.Run;
+	Aparkour_GP4Ghost* Ghost = Playback.Ghost.Get();
+	const float SampleInterval = 1.0f / Run.SampleRate;
+
+	TArray<FParkourGhostEventRecord, TInlineAllocator<ParkourGhostFormat::MaxEventsPerSample>> Events;
+
+	Playback.Time += DeltaTime;
+	while (Playback.Time >= SampleInterval)
+	{
+		Playback.Time -= SampleInterval;
+		Playback.Previous = Playback.Next;
+
+		// Ghosts loop the run.
+		if (!Run.ReadSample(Playback.Cursor, Playback.Next, Events))
+		{
+			RestartPlayback(Playback);
+			break;
+		}
+
+		for (const FParkourGhostEventRecord& EventRecord : Events)
+		{
+			Ghost->PlayGhostEvent(EventRecord.Event, EventRecord.VaultDistance);
+		}
+	}
+
+	const float Alpha = Playback.Time / SampleInterval;
+	const FVector Location = FMath::Lerp(Run.GetLocation(Playback.Previous), Run.GetLocation(Playback.Next), Alpha);
+	const FRotator Rotation = FMath::Lerp(FRotator(0.0f, Run.GetYaw(Playback.Previous), 0.0f), FRotator(0.0f, Run.GetYaw(Playback.Next), 0.0f), Alpha);
+
+	Ghost->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	Ghost->SetLocomotionSpeed(FMath::Lerp(float(Playback.Previous.Speed), float(Playback.Next.Speed), Alpha));
+}
+
+void Uparkour_GP4GhostSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Recording)
+	{
+		Recording->TimeUntilSample -= DeltaTime;
+		while (Recording && Recording->TimeUntilSample <= 0.0f)
+		{
+			Recording->TimeUntilSample += 1.0f / Recording->SampleRate;
+			RecordSample();
+		}
+	}
+
+	if (Playbacks.Num() == 0)
+	{
+		return;
+	}
+
+	const double PlaybackStartTime = FPlatformTime::Seconds();
+
+	for (int32 Index = Playbacks.Num() - 1; Index >= 0; Index--)
+	{
+		if (!Playbacks[Index].Ghost.IsValid())
+		{
+			Playbacks.RemoveAtSwap(Index);
+			continue;
+		}
+		TickPlayback(Playbacks[Index], DeltaTime);
+	}
+
+	if (BenchmarkTimeLeft > 0.0f)
+	{
+		BenchmarkPlaybackSeconds += FPlatformTime::Seconds() - PlaybackStartTime;
+		BenchmarkTicks++;
+		BenchmarkTimeLeft -= DeltaTime;
+		if (BenchmarkTimeLeft <= 0.0f)
+		{
+			FinishBenchmark();
+		}
+	}
+}
+
+void Uparkour_GP4GhostSubsystem::StartBenchmark(const FString& Name, int32 Count, float Seconds)
+{
+	StopAll();
+
+	if (Play(Name, Count, 0.5f) > 0)
+	{
+		BenchmarkRun = Name;
+		BenchmarkTimeLeft = FMath::Max(Seconds, 0.1f);
+		BenchmarkPlaybackSeconds = 0.0;
+		BenchmarkTicks = 0;
+	}
+}
+
+/// <summary>
+/// Logs the memory and game thread cost of the benchmark ghosts. The run file is mapped once and shared,
+/// so the per ghost memory is the playback state plus the ghost actor and its components.
+/// Animation evaluation runs on worker threads and is not part of the playback time.
+/// </summary>
+void Uparkour_GP4GhostSubsystem::FinishBenchmark()
+{
+	const int32 NumGhosts = Playbacks.Num();
+	const int64 RunBytes = NumGhosts ? Playbacks[0].Run->Size : 0;
+
+	int64 GhostBytes = 0;
+	for (const FPlayback& Playback : Playbacks)
+	{
+		GhostBytes += sizeof(FPlayback);
+		if (Aparkour_GP4Ghost* Ghost = Playback.Ghost.Get())
+		{
+			GhostBytes += Ghost->GetClass()->GetStructureSize() + Ghost->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			Ghost->ForEachComponent(false, [&GhostBytes](const UActorComponent* Component)
+			{
+				GhostBytes += Component->GetClass()->GetStructureSize() + Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			});
+		}
+	}
+
+	const double PlaybackMs = BenchmarkTicks ? BenchmarkPlaybackSeconds * 1000.0 / BenchmarkTicks : 0.0;
+	UE_LOG(LogTemp, Display, TEXT("Ghost benchmark '%s': %d ghosts, run file %lld bytes shared, %lld bytes per ghost, %.3f ms playback per frame, %.2f us per ghost"),
+		*BenchmarkRun, NumGhosts, RunBytes, NumGhosts ? GhostBytes / NumGhosts : 0, PlaybackMs, NumGhosts ? PlaybackMs * 1000.0 / NumGhosts : 0.0);
+
+	StopAll();
+}
+
+TStatId Uparkour_GP4GhostSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(Uparkour_GP4GhostSubsystem, STATGROUP_Tickables);
+}
+
+#if !UE_BUILD_SHIPPING
+static Uparkour_GP4GhostSubsystem* GetGhostSubsystem(UWorld* World)
+{
+	return World ? World->GetSubsystem<Uparkour_GP4GhostSubsystem>() : nullptr;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GhostRecordCommand(
+	TEXT("parkour.Ghost.Record"),
+	TEXT("Records the local player's run as a ghost. Args: <Name>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		Uparkour_GP4GhostSubsystem* Subsystem = GetGhostSubsystem(World);
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		if (Subsystem && PlayerController && Args.Num() > 0)
+		{
+			Subsystem->StartRecording(Cast<ACharacter>(PlayerController->GetPawn()), Args[0]);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GhostStopRecordingCommand(
+	TEXT("parkour.Ghost.StopRecording"),
+	TEXT("Stops the current ghost recording."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (Uparkour_GP4GhostSubsystem* Subsystem = GetGhostSubsystem(World))
+		{
+			Subsystem->StopRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GhostPlayCommand(
+	TEXT("parkour.Ghost.Play"),
+	TEXT("Plays a recorded ghost run. Args: <Name> [Count=1] [Spacing=1 second]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		Uparkour_GP4GhostSubsystem* Subsystem = GetGhostSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			const int32 Count = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1;
+			const float Spacing = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 1.0f;
+			Subsystem->Play(Args[0], Count, Spacing);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GhostStopAllCommand(
+	TEXT("parkour.Ghost.StopAll"),
+	TEXT("Removes all playing ghosts."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (Uparkour_GP4GhostSubsystem* Subsystem = GetGhostSubsystem(World))
+		{
+			Subsystem->StopAll();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GhostBenchmarkCommand(
+	TEXT("parkour.Ghost.Benchmark"),
+	TEXT("Plays many copies of a ghost run and logs the memory per ghost and the playback cost. Args: <Name> [Count=50] [Seconds=10]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		Uparkour_GP4GhostSubsystem* Subsystem = GetGhostSubsystem(World);
+		if (Subsystem && Args.Num() > 0)
+		{
+			const int32 Count = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 50;
+			const float Seconds = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 10.0f;
+			Subsystem->StartBenchmark(Args[0], Count, Seconds);
+		}
+	}));
+#endif
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4Ghost.generated.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UAnimSequence;
+class USkeletalMeshComponent;
+
+/**
+ * Ghost run file, written while recording and memory mapped for playback.
+ *
+ * Header: Magic, Version, SampleRate (uint16), PositionQuantum (float, cm per unit).
+ * Then one record per sample:
+ *   Tag byte: number of events in the low 3 bits, KeyframeFlag if the sample is absolute.
+ *   X, Y, Z: zigzag varints, quantized position for a keyframe or the difference to the previous sample.
+ *   Yaw: zigzag varint, compressed axis for a keyframe or the wrapped difference to the previous sample.
+ *   Speed: zigzag varint in cm/s, absolute for a keyframe or the difference to the previous sample.
+ *   Events: event byte, followed by a varint VaultDistance for vaults.
+ * A keyframe is written every second so a file cut short by a crash still plays up to its last complete sample.
+ */
+namespace ParkourGhostFormat
+{
+	static constexpr uint32 Magic = 0x48474B50; // PKGH
+	static constexpr uint16 Version = 1;
+	static constexpr int32 HeaderSize = 12;
+	static constexpr uint8 KeyframeFlag = 0x08;
+	static constexpr uint8 EventCountMask = 0x07;
+	static constexpr int32 MaxEventsPerSample = 7;
+}
+
+/** One decoded sample, quantized the same way it is stored. */
+struct FParkourGhostSample
+{
+	int32 Position[3] = { 0, 0, 0 };
+	int32 Yaw = 0;
+	int32 Speed = 0;
+};
+
+struct FParkourGhostEventRecord
+{
+	EParkourTraversalEvent Event = EParkourTraversalEvent::SlideStart;
+	int32 VaultDistance = 0;
+};
+
+/** A ghost run file mapped into memory, shared by every ghost playing it. */
+struct FParkourGhostRun
+{
+	~FParkourGhostRun();
+
+	/** Maps the file and checks its header, returns null if it is not a ghost run. */
+	static TSharedPtr<FParkourGhostRun> Open(const FString& Filename);
+
+	/** Decodes the sample at Cursor on top of InOutSample and moves the cursor past it. Returns false at the end of the run. */
+	bool ReadSample(int64& Cursor, FParkourGhostSample& InOutSample, TArray<FParkourGhostEventRecord, TInlineAllocator<ParkourGhostFormat::MaxEventsPerSample>>& OutEvents) const;
+
+	FVector GetLocation(const FParkourGhostSample& Sample) const;
+	float GetYaw(const FParkourGhostSample& Sample) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	uint16 SampleRate = 30;
+	float PositionQuantum = 0.5f;
+};
+
+/**
+ * Lightweight stand-in for a recorded character: a skeletal mesh without collision, movement component or tick.
+ * Uparkour_GP4GhostSubsystem places it every frame and picks the animation from the recorded speed and events.
+ */
+UCLASS(Blueprintable)
+class Aparkour_GP4Ghost : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	Aparkour_GP4Ghost();
+
+	/** Loops the idle or run animation unless an event animation is still playing. */
+	void SetLocomotionSpeed(float Speed);
+
+	/** Plays the animation for a recorded traversal event. */
+	void PlayGhostEvent(EParkourTraversalEvent Event, int32 VaultDistance);
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Mesh)
+		USkeletalMeshComponent* Mesh;
+
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		UAnimSequence* IdleAnimation;
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		UAnimSequence* RunAnimation;
+	/** Speed the run animation was authored at, the play rate follows the recorded speed. */
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		float RunAnimationSpeed = 500.0f;
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		UAnimSequence* SlideAnimation;
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		UAnimSequence* VaultAnimation;
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		UAnimSequence* MantleAnimation;
+	UPROPERTY(EditDefaultsOnly, Category = Animation)
+		UAnimSequence* RunToStopAnimation;
+
+protected:
+	/** Called for every recorded traversal event after the animation was picked. */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Ghost")
+		void OnGhostEvent(EParkourTraversalEvent Event, int32 VaultDistance);
+
+private:
+	void PlayLooping(UAnimSequence* Animation);
+
+	UAnimSequence* CurrentLoop = nullptr;
+	bool bSliding = false;
+	double EventAnimationEndTime = 0.0;
+};
+
+/**
+ * Records the local player's run as a ghost and plays ghost runs back.
+ * All ghosts are advanced here in one tick instead of each ghost ticking on its own.
+ *
+ * parkour.Ghost.Record <Name>, parkour.Ghost.StopRecording, parkour.Ghost.Play <Name> [Count] [Spacing],
+ * parkour.Ghost.StopAll and parkour.Ghost.Benchmark <Name> [Count] [Seconds] drive it from the console.
+ */
+UCLASS(config=Game)
+class Uparkour_GP4GhostSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Adds an event to the current recording if Character is the one being recorded. */
+	static void RecordEvent(const AActor* Character, EParkourTraversalEvent Event, int32 VaultDistance = 0);
+
+	static FString GetGhostFilename(const FString& Name);
+
+	bool StartRecording(const ACharacter* Character, const FString& Name);
+	void StopRecording();
+
+	/** Starts Count ghosts of the run, each one Spacing seconds behind the previous one. */
+	int32 Play(const FString& Name, int32 Count, float Spacing);
+	void StopAll();
+
+	void StartBenchmark(const FString& Name, int32 Count, float Seconds);
+
+	/** Blueprint class used for the ghosts, the native class has no mesh set. */
+	UPROPERTY(Config)
+		TSoftClassPtr<Aparkour_GP4Ghost> GhostClass;
+
+private:
+	struct FRecording
+	{
+		TWeakObjectPtr<const ACharacter> Character;
+		TUniquePtr<FArchive> File;
+		TArray<uint8> Buffer;
+		TArray<FParkourGhostEventRecord> PendingEvents;
+		FParkourGhostSample LastSample;
+		float PositionQuantum = 0.5f;
+		int32 SampleRate = 30;
+		int32 SamplesSinceKeyframe = 0;
+		float TimeUntilSample = 0.0f;
+		int64 NumSamples = 0;
+	};
+
+	struct FPlayback
+	{
+		TSharedPtr<FParkourGhostRun> Run;
+		TWeakObjectPtr<Aparkour_GP4Ghost> Ghost;
+		int64 Cursor = 0;
+		FParkourGhostSample Previous;
+		FParkourGhostSample Next;
+		float Time = 0.0f;
+	};
+
+	void RecordSample();
+	void FlushRecording();
+	void TickPlayback(FPlayback& Playback, float DeltaTime);
+	void RestartPlayback(FPlayback& Playback);
+	void FinishBenchmark();
+
+	TUniquePtr<FRecording> Recording;
+	TArray<FPlayback> Playbacks;
+	TMap<FString, TWeakPtr<FParkourGhostRun>> OpenRuns;
+
+	// Benchmark state, playback cost is measured around the whole ghost update.
+	FString BenchmarkRun;
+	float BenchmarkTimeLeft = 0.0f;
+	double BenchmarkPlaybackSeconds = 0.0;
+	int32 BenchmarkTicks = 0;
+};
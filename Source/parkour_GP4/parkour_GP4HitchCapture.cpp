@@ -0,0 +1,248 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4HitchCapture.h"
+#include "parkour_GP4Character.h"
+#include "parkour_GP4TraversalTickManager.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<bool> CVarHitchCapture(
+	TEXT("parkour.HitchCapture"),
+	true,
+	TEXT("Record the traversal work of every parkour character and write it out when a frame takes too long."));
+
+static TAutoConsoleVariable<float> CVarHitchCaptureThresholdMs(
+	TEXT("parkour.HitchCapture.ThresholdMs"),
+	50.0f,
+	TEXT("Frame time in ms that counts as a hitch."));
+
+static TAutoConsoleVariable<float> CVarHitchCaptureSeconds(
+	TEXT("parkour.HitchCapture.Seconds"),
+	3.0f,
+	TEXT("Seconds before the hitch written to the capture."));
+
+static TAutoConsoleVariable<float> CVarHitchCaptureCooldown(
+	TEXT("parkour.HitchCapture.Cooldown"),
+	10.0f,
+	TEXT("Minimum seconds between two captures, so a run of hitches does not write a file every frame."));
+
+template<typename T>
+static void AppendValue(TArray<uint8>& Buffer, const T& Value)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+}
+
+bool Uparkour_GP4HitchCaptureSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void Uparkour_GP4HitchCaptureSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Collection.InitializeDependency<Uparkour_GP4TraversalTickManager>();
+
+	Frames.SetNum(MaxFrames);
+	Entries.SetNum(MaxEntries);
+	LastNumQueries.Reserve(64);
+}
+
+void Uparkour_GP4HitchCaptureSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!CVarHitchCapture.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	// The delta of this frame is how long the previous one took, so it completes the frame recorded last tick before this one is started.
+	if (NumFramesRecorded > 0)
+	{
+		const float FrameMs = FApp::GetDeltaTime() * 1000.0f;
+		Frames[(NumFramesRecorded - 1) % MaxFrames].FrameMs = FrameMs;
+
+		const double Now = FPlatformTime::Seconds();
+		if (FrameMs > CVarHitchCaptureThresholdMs.GetValueOnGameThread() && Now - LastDumpTime > CVarHitchCaptureCooldown.GetValueOnGameThread())
+		{
+			LastDumpTime = Now;
+			Dump(FrameMs);
+		}
+	}
+
+	RecordFrame();
+}
+
+void Uparkour_GP4HitchCaptureSubsystem::RecordFrame()
+{
+	const uint64 FrameIndex = NumFramesRecorded;
+	FParkourHitchFrame& Frame = Frames[FrameIndex % MaxFrames];
+	Frame.FrameNumber = static_cast<uint32>(GFrameCounter);
+	Frame.WorldTime = GetWorld()->GetTimeSeconds();
+	Frame.FrameMs = 0.0f;
+	Frame.FirstEntry = NumEntriesRecorded;
+	Frame.NumEntries = 0;
+	NumFramesRecorded++;
+
+	const Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>();
+	if (TickManager == nullptr)
+	{
+		return;
+	}
+
+	for (const TWeakObjectPtr<Aparkour_GP4Character>& CharacterPtr : TickManager->GetCharacters())
+	{
+		Aparkour_GP4Character* Character = CharacterPtr.Get();
+		if (Character == nullptr)
+		{
+			continue;
+		}
+
+		const uint32 CharacterId = Character->GetUniqueID();
+		const uint32 NumQueries = Character->GetNumTraversalQueries();
+		FLastQueries& LastQueries = LastNumQueries.FindOrAdd(CharacterId, FLastQueries{ NumQueries, FrameIndex });
+		const uint32 FrameQueries = NumQueries - LastQueries.NumQueries;
+		LastQueries.NumQueries = NumQueries;
+		LastQueries.Frame = FrameIndex;
+
+		const uint8 Events = Character->ConsumeTraversalEvents();
+		if ((FrameQueries == 0 && Events == 0 && !Character->IsSliding) || Frame.NumEntries == MAX_uint16)
+		{
+			continue;
+		}
+
+		const Uparkour_GP4MovementComponent* Movement = Character->GetParkourMovement();
+
+		FParkourHitchEntry& Entry = Entries[NumEntriesRecorded % MaxEntries];
+		Entry.CharacterId = CharacterId;
+		Entry.NumQueries = static_cast<uint16>(FMath::Min<uint32>(FrameQueries, MAX_uint16));
+		Entry.Events = Events;
+		Entry.Flags = static_cast<uint8>((Character->IsSliding ? ParkourHitchFormat::FlagSliding : 0)
+			| (Movement->IsFalling() ? ParkourHitchFormat::FlagFalling : 0)
+			| (Character->IsSprinting ? ParkourHitchFormat::FlagSprinting : 0)
+			| (static_cast<uint8>(Movement->GetSprintState()) << ParkourHitchFormat::SprintStateShift));
+
+		NumEntriesRecorded++;
+		Frame.NumEntries++;
+	}
+
+	// Removing keeps the reserved storage, so the map stays as large as the most characters there were at once.
+	if (LastNumQueries.Num() > TickManager->GetCharacters().Num())
+	{
+		for (TMap<uint32, FLastQueries>::TIterator It = LastNumQueries.CreateIterator(); It; ++It)
+		{
+			if (It.Value().Frame != FrameIndex)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Copies the frames of the last parkour.HitchCapture.Seconds out of the rings, skipping frames whose entries were already overwritten,
+/// and writes them to disk on a worker thread so the capture does not add to the hitch.
+/// </summary>
+FString Uparkour_GP4HitchCaptureSubsystem::Dump(float FrameMs)
+{
+	const float OldestTime = GetWorld()->GetTimeSeconds() - CVarHitchCaptureSeconds.GetValueOnGameThread();
+	const uint64 OldestFrame = NumFramesRecorded > MaxFrames ? NumFramesRecorded - MaxFrames : 0;
+	const uint64 OldestEntry = NumEntriesRecorded > MaxEntries ? NumEntriesRecorded - MaxEntries : 0;
+
+	uint64 FirstFrame = NumFramesRecorded;
+	while (FirstFrame > OldestFrame)
+	{
+		const FParkourHitchFrame& Frame = Frames[(FirstFrame - 1) % MaxFrames];
+		if (Frame.WorldTime < OldestTime || Frame.FirstEntry < OldestEntry)
+		{
+			break;
+		}
+		FirstFrame--;
+	}
+
+	TArray<uint8> Buffer;
+	AppendValue(Buffer, ParkourHitchFormat::Magic);
+	AppendValue(Buffer, ParkourHitchFormat::Version);
+
+	// Names of the characters that are still around, the timeline shows the id for the others.
+	TArray<TPair<uint32, FString>> Names;
+	if (const Uparkour_GP4TraversalTickManager* TickManager = GetWorld()->GetSubsystem<Uparkour_GP4TraversalTickManager>())
+	{
+		for (const TWeakObjectPtr<Aparkour_GP4Character>& Character : TickManager->GetCharacters())
+		{
+			if (Character.IsValid())
+			{
+				Names.Emplace(Character->GetUniqueID(), Character->GetName());
+			}
+		}
+	}
+
+	AppendValue(Buffer, static_cast<uint16>(Names.Num()));
+	AppendValue(Buffer, static_cast<uint32>(NumFramesRecorded - FirstFrame));
+	// Dump runs before the new frame is recorded, so the frame that hitched is the last one in the ring.
+	AppendValue(Buffer, NumFramesRecorded > 0 ? Frames[(NumFramesRecorded - 1) % MaxFrames].FrameNumber : static_cast<uint32>(GFrameCounter));
+	AppendValue(Buffer, CVarHitchCaptureThresholdMs.GetValueOnGameThread());
+
+	for (const TPair<uint32, FString>& Name : Names)
+	{
+		const FTCHARToUTF8 Utf8Name(*Name.Value);
+		AppendValue(Buffer, Name.Key);
+		AppendValue(Buffer, static_cast<uint16>(Utf8Name.Length()));
+		Buffer.Append(reinterpret_cast<const uint8*>(Utf8Name.Get()), Utf8Name.Length());
+	}
+
+	for (uint64 FrameIndex = FirstFrame; FrameIndex < NumFramesRecorded; FrameIndex++)
+	{
+		const FParkourHitchFrame& Frame = Frames[FrameIndex % MaxFrames];
+		AppendValue(Buffer, Frame.FrameNumber);
+		AppendValue(Buffer, Frame.WorldTime);
+		AppendValue(Buffer, Frame.FrameMs);
+		AppendValue(Buffer, Frame.NumEntries);
+		for (uint64 EntryIndex = Frame.FirstEntry; EntryIndex < Frame.FirstEntry + Frame.NumEntries; EntryIndex++)
+		{
+			AppendValue(Buffer, Entries[EntryIndex % MaxEntries]);
+		}
+	}
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("Hitches")
+		/ FString::Printf(TEXT("Hitch_%s_%u.pkhitch"), *FDateTime::Now().ToString(), static_cast<uint32>(GFrameCounter));
+
+	UE_LOG(LogTemp, Warning, TEXT("%.1f ms frame, writing %llu frames of traversal state to %s"), FrameMs, NumFramesRecorded - FirstFrame, *Filename);
+
+	Async(EAsyncExecution::ThreadPool, [Buffer = MoveTemp(Buffer), Filename]()
+	{
+		FFileHelper::SaveArrayToFile(Buffer, *Filename);
+	});
+
+	return Filename;
+}
+
+TStatId Uparkour_GP4HitchCaptureSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(Uparkour_GP4HitchCaptureSubsystem, STATGROUP_Tickables);
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld HitchCaptureDumpCommand(
+	TEXT("parkour.HitchCapture.Dump"),
+	TEXT("Writes the traversal state of the last seconds to Saved/Profiling/Hitches without waiting for a hitch."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (Uparkour_GP4HitchCaptureSubsystem* Subsystem = World ? World->GetSubsystem<Uparkour_GP4HitchCaptureSubsystem>() : nullptr)
+		{
+			Subsystem->Dump(FApp::GetDeltaTime() * 1000.0f);
+		}
+	}));
+#endif
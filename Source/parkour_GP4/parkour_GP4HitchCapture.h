@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "parkour_GP4HitchCapture.generated.h"
+
+/**
+ * Hitch capture file, converted to a readable timeline by Scripts/ParkourHitchTimeline.py.
+ *
+ * Header: Magic, Version (uint16), NumNames (uint16), NumFrames (uint32), HitchFrame (uint32), ThresholdMs (float).
+ * Names: CharacterId (uint32), name length (uint16), UTF-8 name.
+ * Frames: FrameNumber (uint32), WorldTime (float), FrameMs (float), NumEntries (uint16), then NumEntries FParkourHitchEntry.
+ * Everything is little endian.
+ */
+namespace ParkourHitchFormat
+{
+	static constexpr uint32 Magic = 0x43484B50; // PKHC
+	static constexpr uint16 Version = 1;
+
+	static constexpr uint8 FlagSliding = 0x01;
+	static constexpr uint8 FlagFalling = 0x02;
+	static constexpr uint8 FlagSprinting = 0x04;
+	static constexpr uint8 SprintStateShift = 4;
+}
+
+/** What one character did in one frame, only written for frames it traced or had an event in. */
+struct FParkourHitchEntry
+{
+	uint32 CharacterId = 0;
+	/** Traversal traces this frame. */
+	uint16 NumQueries = 0;
+	/** Mask of 1 << EParkourTraversalEvent. */
+	uint8 Events = 0;
+	/** ParkourHitchFormat flags, sprint state in the high bits. */
+	uint8 Flags = 0;
+};
+static_assert(sizeof(FParkourHitchEntry) == 8, "Hitch entries are written as they are in memory");
+
+struct FParkourHitchFrame
+{
+	uint32 FrameNumber = 0;
+	float WorldTime = 0.0f;
+	/** Filled in on the next tick, once the frame is over. */
+	float FrameMs = 0.0f;
+	/** Index of the first entry in the entry ring, counted from the start of the capture. */
+	uint64 FirstEntry = 0;
+	uint16 NumEntries = 0;
+};
+
+/**
+ * Always on recorder of the traversal work of every parkour character.
+ * Frames and entries go into two fixed size rings, nothing is allocated while recording.
+ * When a frame takes longer than parkour.HitchCapture.ThresholdMs the last parkour.HitchCapture.Seconds
+ * are written to Saved/Profiling/Hitches on a worker thread.
+ */
+UCLASS()
+class Uparkour_GP4HitchCaptureSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Writes the captured frames now, returns the file name. */
+	FString Dump(float FrameMs);
+
+private:
+	void RecordFrame();
+
+	static constexpr int32 MaxFrames = 1024;
+	static constexpr int32 MaxEntries = 16384;
+
+	TArray<FParkourHitchFrame> Frames;
+	TArray<FParkourHitchEntry> Entries;
+	uint64 NumFramesRecorded = 0;
+	uint64 NumEntriesRecorded = 0;
+
+	struct FLastQueries
+	{
+		uint32 NumQueries = 0;
+		/** Last frame the character was seen in, characters that left are pruned by it. */
+		uint64 Frame = 0;
+	};
+
+	/** Trace count of every character at the end of the last frame, to record the traces per frame. */
+	TMap<uint32, FLastQueries> LastNumQueries;
+
+	double LastDumpTime = -BIG_NUMBER;
+};
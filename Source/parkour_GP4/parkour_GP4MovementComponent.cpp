@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4MovementComponent.h"
+#include "parkour_GP4Character.h"
+#include "parkour_GP4NetRate.h"
+#include "GameFramework/Character.h"
+#include "Net/UnrealNetwork.h"
+
+void Uparkour_GP4MovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!bSprintStateBatched && ShouldUpdateSprintState())
+	{
+		UpdateSprintState(DeltaTime);
+	}
+}
+
+bool Uparkour_GP4MovementComponent::ShouldUpdateSprintState() const
+{
+	// Simulated proxies have no acceleration or sprint input, they only get what the owner replicates.
+	return CharacterOwner && (CharacterOwner->IsLocallyControlled() || CharacterOwner->HasAuthority());
+}
+
+void Uparkour_GP4MovementComponent::SetWantsToSprint(bool bInWantsToSprint)
+{
+	if (bWantsToSprint == bInWantsToSprint)
+	{
+		return;
+	}
+	bWantsToSprint = bInWantsToSprint;
+
+	if (const Aparkour_GP4Character* ParkourCharacter = Cast<Aparkour_GP4Character>(CharacterOwner))
+	{
+		MaxWalkSpeed = bWantsToSprint ? ParkourCharacter->SprintSpeed : ParkourCharacter->DefaultWalkSpeed;
+	}
+}
+
+/// <summary>
+/// Advances the sprint state machine from the movement state of this tick.
+/// Started -> Sustained once the sprint lasted SprintSustainTime, Started/Sustained -> Stopping when the sprint input is released at speed,
+/// Stopping -> Stopped once the character has slowed down.
+/// Letting go of the movement input while still holding sprint goes straight to Stopped, the run to stop only plays when the sprint is released.
+/// </summary>
+void Uparkour_GP4MovementComponent::UpdateSprintState(float DeltaTime)
+{
+	const float Speed2D = Velocity.Size2D();
+	const bool bMoving = Speed2D > SprintStartMinSpeed && !GetCurrentAcceleration().IsZero();
+	const EParkourSprintState NewState = AdvanceSprintState(SprintState, TimeInSprintState + DeltaTime, Speed2D, bMoving, bWantsToSprint, IsFalling(), SprintSustainTime, RunToStopMinSpeed);
+
+	ApplySprintStep(DeltaTime, bMoving, NewState);
+}
+
+EParkourSprintState Uparkour_GP4MovementComponent::AdvanceSprintState(EParkourSprintState State, float TimeInState, float Speed2D, bool bInIsMovingWithInput, bool bInWantsToSprint, bool bIsFalling, float InSprintSustainTime, float InRunToStopMinSpeed)
+{
+	const bool bSprinting = bInWantsToSprint && bInIsMovingWithInput;
+
+	switch (State)
+	{
+	case EParkourSprintState::Stopped:
+		if (bSprinting)
+		{
+			return EParkourSprintState::Started;
+		}
+		break;
+
+	case EParkourSprintState::Started:
+	case EParkourSprintState::Sustained:
+		if (!bSprinting)
+		{
+			const bool bCanRunToStop = !bInWantsToSprint && !bIsFalling && Speed2D > InRunToStopMinSpeed;
+			return bCanRunToStop ? EParkourSprintState::Stopping : EParkourSprintState::Stopped;
+		}
+		else if (State == EParkourSprintState::Started && TimeInState >= InSprintSustainTime)
+		{
+			return EParkourSprintState::Sustained;
+		}
+		break;
+
+	case EParkourSprintState::Stopping:
+		if (bSprinting)
+		{
+			return EParkourSprintState::Started;
+		}
+		else if (Speed2D <= InRunToStopMinSpeed || bIsFalling)
+		{
+			return EParkourSprintState::Stopped;
+		}
+		break;
+	}
+
+	return State;
+}
+
+void Uparkour_GP4MovementComponent::ApplySprintStep(float DeltaTime, bool bInIsMovingWithInput, EParkourSprintState NewState)
+{
+	TimeInSprintState += DeltaTime;
+	bIsMovingWithInput = bInIsMovingWithInput;
+
+	if (NewState != SprintState)
+	{
+		SetSprintState(NewState);
+	}
+}
+
+void Uparkour_GP4MovementComponent::SetSprintState(EParkourSprintState NewState)
+{
+	const EParkourSprintState PreviousState = SprintState;
+	SprintState = NewState;
+	TimeInSprintState = 0.0f;
+
+	OnSprintStateChanged.Broadcast(NewState, PreviousState);
+}
+
+void Uparkour_GP4MovementComponent::OnRep_SprintState()
+{
+	TimeInSprintState = 0.0f;
+}
+
+void Uparkour_GP4MovementComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owning client runs its own state machine from the same input.
+	DOREPLIFETIME_CONDITION(Uparkour_GP4MovementComponent, SprintState, COND_SimulatedOnly);
+}
+
+void Uparkour_GP4MovementComponent::ServerSendMoveResponse(const FClientAdjustment& PendingAdjustment)
+{
+	// Anything that is not a good move ack is a correction the client has to replay.
+	if (!PendingAdjustment.bAckGoodMove)
+	{
+		ServerCorrectionCount++;
+	}
+
+	Super::ServerSendMoveResponse(PendingAdjustment);
+}
+
+float Uparkour_GP4MovementComponent::GetClientNetSendDeltaTime(const APlayerController* PC, const FNetworkPredictionData_Client_Character* ClientData, const FSavedMovePtr& NewMove) const
+{
+	const float DeltaTime = Super::GetClientNetSendDeltaTime(PC, ClientData, NewMove);
+
+	const Aparkour_GP4Character* ParkourCharacter = Cast<Aparkour_GP4Character>(CharacterOwner);
+	return ParkourCharacter ? Uparkour_GP4NetRateSubsystem::GetClientMoveDeltaTime(ParkourCharacter, DeltaTime) : DeltaTime;
+}
+
+FNetworkPredictionData_Client* Uparkour_GP4MovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		Uparkour_GP4MovementComponent* MutableThis = const_cast<Uparkour_GP4MovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Parkour(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void Uparkour_GP4MovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	SetWantsToSprint((Flags & FSavedMove_Character::FLAG_Custom_0) != 0);
+
+	// Replayed moves on the owning client carry its own state, which it already has.
+	Aparkour_GP4Character* ParkourCharacter = Cast<Aparkour_GP4Character>(CharacterOwner);
+	if (ParkourCharacter == nullptr || !ParkourCharacter->HasAuthority())
+	{
+		return;
+	}
+
+	const bool bTraversing = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
+	const bool bTraversalStarted = bTraversing && !bClientTraversing;
+	bClientSliding = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+	bClientTraversing = bTraversing;
+
+	// Vaults, mantles and slide onsets start on the owning client, the server raises the rate as soon as the first move of one arrives.
+	if (bTraversalStarted)
+	{
+		Uparkour_GP4NetRateSubsystem::BeginTraversalBurst(ParkourCharacter);
+	}
+}
+
+int32 Uparkour_GP4MovementComponent::ConsumeServerCorrections()
+{
+	const int32 Corrections = ServerCorrectionCount;
+	ServerCorrectionCount = 0;
+	return Corrections;
+}
+
+void FSavedMove_Parkour::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToSprint = false;
+	bSavedSliding = false;
+	bSavedTraversing = false;
+}
+
+uint8 FSavedMove_Parkour::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+	if (bSavedWantsToSprint)
+	{
+		Result |= FLAG_Custom_0;
+	}
+	if (bSavedSliding)
+	{
+		Result |= FLAG_Custom_1;
+	}
+	if (bSavedTraversing)
+	{
+		Result |= FLAG_Custom_2;
+	}
+	return Result;
+}
+
+bool FSavedMove_Parkour::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_Parkour* NewParkourMove = static_cast<const FSavedMove_Parkour*>(NewMove.Get());
+	if (bSavedWantsToSprint != NewParkourMove->bSavedWantsToSprint || bSavedSliding != NewParkourMove->bSavedSliding || bSavedTraversing != NewParkourMove->bSavedTraversing)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Parkour::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const Uparkour_GP4MovementComponent* Movement = Cast<Uparkour_GP4MovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToSprint = Movement->WantsToSprint();
+	}
+	if (const Aparkour_GP4Character* ParkourCharacter = Cast<Aparkour_GP4Character>(C))
+	{
+		bSavedSliding = ParkourCharacter->IsSliding;
+		bSavedTraversing = Uparkour_GP4NetRateSubsystem::IsTraversingLocally(ParkourCharacter);
+	}
+}
+
+FNetworkPredictionData_Client_Parkour::FNetworkPredictionData_Client_Parkour(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Parkour::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Parkour());
+}
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "parkour_GP4MovementComponent.generated.h"
+
+/** Sprint states, advanced once per movement tick. */
+UENUM(BlueprintType)
+enum class EParkourSprintState : uint8
+{
+	Stopped,
+	Started,
+	Sustained,
+	Stopping
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FParkourSprintStateChangedSignature, EParkourSprintState, NewState, EParkourSprintState, PreviousState);
+
+/**
+ * Saved move carrying the sprint input, so the server and replayed moves see the same sprint input as the owning client did.
+ * Also carries whether the owning client is sliding or traversing, which only it knows, for the server's net rate tiers.
+ */
+class FSavedMove_Parkour : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+
+	uint8 bSavedWantsToSprint : 1;
+	uint8 bSavedSliding : 1;
+	uint8 bSavedTraversing : 1;
+};
+
+class FNetworkPredictionData_Client_Parkour : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	explicit FNetworkPredictionData_Client_Parkour(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ * Character movement used by Aparkour_GP4Character.
+ * Runs the sprint state machine and keeps track of the server side movement corrections so soak tests can report them.
+ * The sprint input is sent with every move as FLAG_Custom_0, so the server runs the same sprint state machine and speed as the owning client.
+ * FLAG_Custom_1 and FLAG_Custom_2 tell the server the owning client is sliding or traversing, see Uparkour_GP4NetRateSubsystem::GetTier.
+ */
+UCLASS()
+class Uparkour_GP4MovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void ServerSendMoveResponse(const FClientAdjustment& PendingAdjustment) override;
+	virtual float GetClientNetSendDeltaTime(const APlayerController* PC, const FNetworkPredictionData_Client_Character* ClientData, const FSavedMovePtr& NewMove) const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Returns the number of corrections sent to the owning client since the last call and resets the count. */
+	int32 ConsumeServerCorrections();
+
+	/** Set while the sprint input is held, switches MaxWalkSpeed between the character's sprint and default walk speed. */
+	void SetWantsToSprint(bool bInWantsToSprint);
+	bool WantsToSprint() const { return bWantsToSprint; }
+
+	/** Slide and traversal state the owning client sent with its last move, only set on the server. */
+	bool IsClientSliding() const { return bClientSliding; }
+	bool IsClientTraversing() const { return bClientTraversing; }
+
+	/** Simulated proxies have no acceleration or sprint input, only the owner and the server run the sprint state machine. */
+	bool ShouldUpdateSprintState() const;
+	float GetTimeInSprintState() const { return TimeInSprintState; }
+
+	/** One sprint state machine step. Touches no UObjects so it can run batched off the game thread. */
+	static EParkourSprintState AdvanceSprintState(EParkourSprintState State, float TimeInState, float Speed2D, bool bInIsMovingWithInput, bool bInWantsToSprint, bool bIsFalling, float InSprintSustainTime, float InRunToStopMinSpeed);
+
+	/** Applies a sprint step computed by the traversal tick manager, broadcasting the transition if there is one. */
+	void ApplySprintStep(float DeltaTime, bool bInIsMovingWithInput, EParkourSprintState NewState);
+
+	/** Set while the traversal tick manager advances the sprint state, TickComponent then leaves it alone. */
+	bool bSprintStateBatched = false;
+
+	/** Replicated to simulated proxies, so remote characters can be animated from it. */
+	UFUNCTION(BlueprintPure, Category = "Movement")
+		EParkourSprintState GetSprintState() const { return SprintState; }
+
+	/** True while moving with input faster than SprintStartMinSpeed, updated once per tick. */
+	UFUNCTION(BlueprintPure, Category = "Movement")
+		bool IsMovingWithInput() const { return bIsMovingWithInput; }
+
+	/** Broadcast on every sprint state transition, subscribe to this instead of polling the velocity. */
+	UPROPERTY(BlueprintAssignable, Category = "Movement")
+		FParkourSprintStateChangedSignature OnSprintStateChanged;
+
+	/** Minimum horizontal speed for the character to count as moving. */
+	UPROPERTY(EditAnywhere, Category = "Movement|Sprint")
+		float SprintStartMinSpeed = 10.0f;
+
+	/** How long the sprint has to last before it counts as sustained. */
+	UPROPERTY(EditAnywhere, Category = "Movement|Sprint")
+		float SprintSustainTime = 0.5f;
+
+	/** Speed the character has to be above when the sprint ends for the run to stop to play. */
+	UPROPERTY(EditAnywhere, Category = "Movement|Sprint")
+		float RunToStopMinSpeed = 50.0f;
+
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+private:
+	void UpdateSprintState(float DeltaTime);
+	void SetSprintState(EParkourSprintState NewState);
+
+	/** Simulated proxies only follow the state, the transitions and their events stay with the owner and the server. */
+	UFUNCTION()
+		void OnRep_SprintState();
+
+	UPROPERTY(ReplicatedUsing = OnRep_SprintState)
+		EParkourSprintState SprintState = EParkourSprintState::Stopped;
+	float TimeInSprintState = 0.0f;
+	bool bWantsToSprint = false;
+	bool bIsMovingWithInput = false;
+	bool bClientSliding = false;
+	bool bClientTraversing = false;
+
+	int32 ServerCorrectionCount = 0;
+};
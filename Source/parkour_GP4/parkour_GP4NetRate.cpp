@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4NetRate.h"
+#include "parkour_GP4Character.h"
+#include "parkour_GP4Course.h"
+#include "parkour_GP4MovementComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarNetRate(
+	TEXT("parkour.NetRate"),
+	true,
+	TEXT("Adapt the replication rate of parkour characters to their traversal state and cull them by distance along the course."));
+
+static TAutoConsoleVariable<float> CVarNetRateUpdateInterval(
+	TEXT("parkour.NetRate.UpdateInterval"),
+	0.1f,
+	TEXT("Seconds between two updates of the replication rates on the server. Traversal events update their character right away."));
+
+static TAutoConsoleVariable<float> CVarNetRateBurstSeconds(
+	TEXT("parkour.NetRate.BurstSeconds"),
+	0.5f,
+	TEXT("How long a character stays at the traversal rate after a vault, mantle, slide or run to stop begins."));
+
+static TAutoConsoleVariable<float> CVarNetRateTraversal(
+	TEXT("parkour.NetRate.Traversal"),
+	100.0f,
+	TEXT("Replication rate in Hz during vault and mantle warps and right after traversal events."));
+
+static TAutoConsoleVariable<float> CVarNetRateMoving(
+	TEXT("parkour.NetRate.Moving"),
+	60.0f,
+	TEXT("Replication rate in Hz while walking, sliding, jumping or starting a sprint."));
+
+static TAutoConsoleVariable<float> CVarNetRateSprinting(
+	TEXT("parkour.NetRate.Sprinting"),
+	30.0f,
+	TEXT("Replication rate in Hz while sprinting steadily."));
+
+static TAutoConsoleVariable<float> CVarNetRateIdle(
+	TEXT("parkour.NetRate.Idle"),
+	5.0f,
+	TEXT("Replication rate in Hz while standing still."));
+
+static TAutoConsoleVariable<float> CVarNetRateClientTraversal(
+	TEXT("parkour.NetRate.ClientMoveRate.Traversal"),
+	90.0f,
+	TEXT("Minimum rate in Hz at which owning clients send their moves during traversals."));
+
+static TAutoConsoleVariable<float> CVarNetRateClientSprinting(
+	TEXT("parkour.NetRate.ClientMoveRate.Sprinting"),
+	30.0f,
+	TEXT("Maximum rate in Hz at which owning clients send their moves while sprinting steadily."));
+
+static TAutoConsoleVariable<float> CVarNetRateCourseCullDistance(
+	TEXT("parkour.NetRate.CourseCullDistance"),
+	6000.0f,
+	TEXT("Characters further apart than this along the course are not replicated to each other, 0 turns it off. Needs an Aparkour_GP4Course in the map."));
+
+uint64 Uparkour_GP4NetRateSubsystem::TotalCourseCulled = 0;
+
+bool Uparkour_GP4NetRateSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+bool Uparkour_GP4NetRateSubsystem::IsEnabled()
+{
+	return CVarNetRate.GetValueOnGameThread();
+}
+
+/// <summary>
+/// Vault and mantle montages warp the root to the traced points, which simulated proxies can only follow with frequent updates.
+/// The slide and run to stop montages move the character like normal movement does, so they do not count.
+/// </summary>
+bool Uparkour_GP4NetRateSubsystem::IsTraversingLocally(const Aparkour_GP4Character* Character)
+{
+	if (Character->GetWorld()->GetTimeSeconds() < Character->NetBurstEndTime)
+	{
+		return true;
+	}
+
+	const UAnimInstance* AnimInstance = Character->GetMesh()->GetAnimInstance();
+	const UAnimMontage* Montage = AnimInstance ? AnimInstance->GetCurrentActiveMontage() : nullptr;
+	return Montage && Montage != Character->SlidingMontage && Montage != Character->SlidingEndMontage && Montage != Character->RunToStopMontage;
+}
+
+/// <summary>
+/// Slides, vaults and mantles start from the owning client's input and their montages only play there,
+/// so for remote players the server goes by the slide and traversal state that comes with their moves.
+/// </summary>
+EParkourNetRateTier Uparkour_GP4NetRateSubsystem::GetTier(const Aparkour_GP4Character* Character)
+{
+	const Uparkour_GP4MovementComponent* Movement = Character->GetParkourMovement();
+	if (IsTraversingLocally(Character) || Movement->IsClientTraversing())
+	{
+		return EParkourNetRateTier::Traversal;
+	}
+
+	if (Character->IsSliding || Movement->IsClientSliding() || Movement->IsFalling())
+	{
+		return EParkourNetRateTier::Moving;
+	}
+	if (Movement->Velocity.Size2D() <= Movement->SprintStartMinSpeed)
+	{
+		return EParkourNetRateTier::Idle;
+	}
+	if (Movement->GetSprintState() == EParkourSprintState::Sustained)
+	{
+		return EParkourNetRateTier::Sprinting;
+	}
+	return EParkourNetRateTier::Moving;
+}
+
+float Uparkour_GP4NetRateSubsystem::GetTierRate(EParkourNetRateTier Tier)
+{
+	float Rate = 0.0f;
+	switch (Tier)
+	{
+	case EParkourNetRateTier::Idle:			Rate = CVarNetRateIdle.GetValueOnGameThread(); break;
+	case EParkourNetRateTier::Sprinting:	Rate = CVarNetRateSprinting.GetValueOnGameThread(); break;
+	case EParkourNetRateTier::Moving:		Rate = CVarNetRateMoving.GetValueOnGameThread(); break;
+	case EParkourNetRateTier::Traversal:	Rate = CVarNetRateTraversal.GetValueOnGameThread(); break;
+	}
+	return FMath::Max(Rate, 1.0f);
+}
+
+void Uparkour_GP4NetRateSubsystem::BeginTraversalBurst(Aparkour_GP4Character* Character)
+{
+	if (!IsEnabled() || Character->GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	// The owning client needs this as well, it sends its moves faster during the burst.
+	Character->NetBurstEndTime = Character->GetWorld()->GetTimeSeconds() + CVarNetRateBurstSeconds.GetValueOnGameThread();
+	if (Character->HasAuthority())
+	{
+		ApplyTier(Character, EParkourNetRateTier::Traversal);
+	}
+}
+
+float Uparkour_GP4NetRateSubsystem::GetClientMoveDeltaTime(const Aparkour_GP4Character* Character, float DefaultDeltaTime)
+{
+	if (!IsEnabled())
+	{
+		return DefaultDeltaTime;
+	}
+
+	switch (GetTier(Character))
+	{
+	case EParkourNetRateTier::Traversal:
+		return FMath::Min(DefaultDeltaTime, 1.0f / FMath::Max(CVarNetRateClientTraversal.GetValueOnGameThread(), 1.0f));
+	case EParkourNetRateTier::Sprinting:
+		// Moves are combined while nothing changes, so sending less often mostly saves the per packet overhead.
+		return FMath::Max(DefaultDeltaTime, 1.0f / FMath::Max(CVarNetRateClientSprinting.GetValueOnGameThread(), 1.0f));
+	default:
+		// Idle already uses the engine's stationary send rate.
+		return DefaultDeltaTime;
+	}
+}
+
+void Uparkour_GP4NetRateSubsystem::ApplyTier(Aparkour_GP4Character* Character, EParkourNetRateTier Tier)
+{
+	const float Rate = GetTierRate(Tier);
+	if (Rate > Character->NetUpdateFrequency)
+	{
+		// The next update was scheduled at the old rate, which can be a fraction of a second away when coming from idle.
+		Character->NetUpdateFrequency = Rate;
+		Character->ForceNetUpdate();
+	}
+	else
+	{
+		Character->NetUpdateFrequency = Rate;
+	}
+}
+
+bool Uparkour_GP4NetRateSubsystem::IsRelevantAlongCourse(const Aparkour_GP4Character* Character, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	const float CullDistance = CVarNetRateCourseCullDistance.GetValueOnGameThread();
+	if (!IsEnabled() || CullDistance <= 0.0f || !Course.IsValid() || Character->CourseDistance < 0.0f)
+	{
+		return true;
+	}
+
+	// The viewer is normally another parkour character whose course distance was updated with everyone else's.
+	const Aparkour_GP4Character* Viewer = Cast<Aparkour_GP4Character>(ViewTarget);
+	const float ViewerDistance = Viewer && Viewer->CourseDistance >= 0.0f ? Viewer->CourseDistance : Course->GetDistanceAlongCourse(SrcLocation);
+	if (FMath::Abs(Character->CourseDistance - ViewerDistance) <= CullDistance)
+	{
+		return true;
+	}
+
+	TotalCourseCulled++;
+	return false;
+}
+
+void Uparkour_GP4NetRateSubsystem::ClearCourse(Aparkour_GP4Course* InCourse)
+{
+	if (Course.Get() == InCourse)
+	{
+		Course.Reset();
+	}
+}
+
+void Uparkour_GP4NetRateSubsystem::RestoreDefaultRates()
+{
+	for (TActorIterator<Aparkour_GP4Character> It(GetWorld()); It; ++It)
+	{
+		It->NetUpdateFrequency = It->GetClass()->GetDefaultObject<Aparkour_GP4Character>()->NetUpdateFrequency;
+		It->NetBurstEndTime = 0.0;
+		It->CourseDistance = -1.0f;
+	}
+}
+
+void Uparkour_GP4NetRateSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UWorld* World = GetWorld();
+	if (World->GetNetMode() == NM_Standalone || World->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	const bool bEnabled = IsEnabled();
+	if (bEnabled != bWasEnabled)
+	{
+		bWasEnabled = bEnabled;
+		TimeUntilUpdate = 0.0f;
+		if (!bEnabled)
+		{
+			RestoreDefaultRates();
+		}
+	}
+
+	TimeUntilUpdate -= DeltaTime;
+	if (!bEnabled || TimeUntilUpdate > 0.0f)
+	{
+		return;
+	}
+	TimeUntilUpdate = CVarNetRateUpdateInterval.GetValueOnGameThread();
+
+	const Aparkour_GP4Course* CurrentCourse = Course.Get();
+	for (TActorIterator<Aparkour_GP4Character> It(GetWorld()); It; ++It)
+	{
+		Aparkour_GP4Character* Character = *It;
+		if (!Character->HasAuthority())
+		{
+			continue;
+		}
+
+		ApplyTier(Character, GetTier(Character));
+		Character->CourseDistance = CurrentCourse ? CurrentCourse->GetDistanceAlongCourse(Character->GetActorLocation()) : -1.0f;
+	}
+}
+
+TStatId Uparkour_GP4NetRateSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(Uparkour_GP4NetRateSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "parkour_GP4NetRate.generated.h"
+
+class Aparkour_GP4Character;
+class Aparkour_GP4Course;
+
+/** How urgently a character's movement has to reach the other players, picked from its traversal state. */
+enum class EParkourNetRateTier : uint8
+{
+	/** Standing still on the ground. */
+	Idle,
+	/** Sprinting in a straight line for longer than SprintSustainTime, easy to extrapolate. */
+	Sprinting,
+	/** Anything else: walking, starting a sprint, sliding, jumping. */
+	Moving,
+	/** Playing a vault or mantle montage, or shortly after a traversal event like a slide onset. */
+	Traversal
+};
+
+/**
+ * Adapts how often every parkour character replicates to its traversal state, enabled with parkour.NetRate.
+ * The server sets each character's NetUpdateFrequency from its tier a few times per second and right away on traversal events,
+ * owning clients send their moves faster during traversals and slower while sprinting steadily.
+ * When the map has an Aparkour_GP4Course, characters further apart along it than parkour.NetRate.CourseCullDistance are not relevant to each other.
+ */
+UCLASS()
+class Uparkour_GP4NetRateSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static bool IsEnabled();
+
+	/** Tier of the character right now, valid on the server and the owning client. */
+	static EParkourNetRateTier GetTier(const Aparkour_GP4Character* Character);
+
+	/** True during a traversal burst or a vault or mantle montage on this machine. Owning clients send it to the server with their moves. */
+	static bool IsTraversingLocally(const Aparkour_GP4Character* Character);
+
+	/** Replication rate in Hz the server uses for a tier. */
+	static float GetTierRate(EParkourNetRateTier Tier);
+
+	/** Called for every traversal event, keeps the character in the Traversal tier for parkour.NetRate.BurstSeconds. */
+	static void BeginTraversalBurst(Aparkour_GP4Character* Character);
+
+	/** Adjusts the time between the moves an owning client sends to the server, DefaultDeltaTime is what the engine picked. */
+	static float GetClientMoveDeltaTime(const Aparkour_GP4Character* Character, float DefaultDeltaTime);
+
+	/** False if Character is too far along the course from the viewer, called from the character's IsNetRelevantFor. */
+	bool IsRelevantAlongCourse(const Aparkour_GP4Character* Character, const AActor* ViewTarget, const FVector& SrcLocation) const;
+
+	void SetCourse(Aparkour_GP4Course* InCourse) { Course = InCourse; }
+	bool HasCourse() const { return Course.IsValid(); }
+	void ClearCourse(Aparkour_GP4Course* InCourse);
+
+	/** Times a character was culled along the course so far, read by the soak test stats. */
+	static uint64 GetTotalCourseCulled() { return TotalCourseCulled; }
+
+private:
+	static void ApplyTier(Aparkour_GP4Character* Character, EParkourNetRateTier Tier);
+	void RestoreDefaultRates();
+
+	TWeakObjectPtr<Aparkour_GP4Course> Course;
+	float TimeUntilUpdate = 0.0f;
+	bool bWasEnabled = false;
+
+	static uint64 TotalCourseCulled;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4Scalability.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ConfigCacheIni.h"
+
+static void OnParkourQualityChanged(IConsoleVariable* Var)
+{
+	ApplyCVarSettingsGroupFromIni(TEXT("ParkourQuality"), Var->GetInt(), *GScalabilityIni, ECVF_SetByScalability);
+}
+
+static TAutoConsoleVariable<int32> CVarParkourQuality(
+	TEXT("sg.ParkourQuality"),
+	3,
+	TEXT("Scalability quality of the parkour traversal queries.\n")
+	TEXT(" 0:low, 1:med, 2:high, 3:epic (default)"),
+	FConsoleVariableDelegate::CreateStatic(&OnParkourQualityChanged),
+	ECVF_ScalabilityGroup);
+
+static TAutoConsoleVariable<int32> CVarVaultDepthSteps(
+	TEXT("parkour.Vault.DepthSteps"),
+	10,
+	TEXT("Maximum number of depth probes VaultTrace uses to find the far side of an obstacle."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSlideFloorCheckInterval(
+	TEXT("parkour.Slide.FloorCheckInterval"),
+	0.01f,
+	TEXT("Rate of the slide floor check timer in seconds."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarSlideContinueInterval(
+	TEXT("parkour.Slide.ContinueInterval"),
+	0.001f,
+	TEXT("Rate of the continue sliding timer in seconds."),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarShapeComplexity(
+	TEXT("parkour.Traversal.ShapeComplexity"),
+	2,
+	TEXT("Shapes used by the traversal queries.\n")
+	TEXT(" 0: line traces, except the sphere sweeps that find the top of an obstacle\n")
+	TEXT(" 1: sphere sweeps, capsules become line traces along their axis\n")
+	TEXT(" 2: shapes as authored (default)"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<bool> CVarDebugRecording(
+	TEXT("parkour.Traversal.DebugRecording"),
+	true,
+	TEXT("Record the traversal queries of the character shown in the Parkour gameplay debugger category."),
+	ECVF_Scalability);
+
+int32 ParkourScalability::GetVaultDepthSteps()
+{
+	return FMath::Max(1, CVarVaultDepthSteps.GetValueOnGameThread());
+}
+
+float ParkourScalability::GetSlideFloorCheckInterval()
+{
+	return FMath::Max(0.001f, CVarSlideFloorCheckInterval.GetValueOnGameThread());
+}
+
+float ParkourScalability::GetSlideContinueInterval()
+{
+	return FMath::Max(0.001f, CVarSlideContinueInterval.GetValueOnGameThread());
+}
+
+int32 ParkourScalability::GetShapeComplexity()
+{
+	return FMath::Clamp(CVarShapeComplexity.GetValueOnAnyThread(), 0, 2);
+}
+
+bool ParkourScalability::IsDebugRecordingEnabled()
+{
+	return CVarDebugRecording.GetValueOnAnyThread();
+}
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * sg.ParkourQuality scalability group. Each level applies the [ParkourQuality@Level] section of Scalability.ini,
+ * which sets the parkour.* console variables below, so clients and servers can trade traversal precision for throughput.
+ */
+namespace ParkourScalability
+{
+	/** Maximum number of depth probes VaultTrace uses to find the far side of an obstacle. */
+	int32 GetVaultDepthSteps();
+
+	/** Rate of the slide floor check timer in seconds. */
+	float GetSlideFloorCheckInterval();
+
+	/** Rate of the continue sliding timer in seconds. */
+	float GetSlideContinueInterval();
+
+	/**
+	 * 0 turns every sweep into a line trace except the vault depth and mantle ledge probes, 1 keeps sphere sweeps but turns capsules into lines along their axis,
+	 * 2 uses the shapes as authored. The probes kept as sweeps find where the traversal goes, the rest only check for clearance.
+	 * This and IsDebugRecordingEnabled are read by every traversal query, so they can be called from the traversal simulator's worker threads.
+	 */
+	int32 GetShapeComplexity();
+
+	/** If the character shown in the Parkour gameplay debugger category records its traversal queries. */
+	bool IsDebugRecordingEnabled();
+}
@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4SoakTest.h"
+#include "parkour_GP4Character.h"
+#include "parkour_GP4MovementComponent.h"
+#include "parkour_GP4NetRate.h"
+#include "parkour_GP4TraversalPrefilter.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "EnhancedInputSubsystems.h"
+#include "InputActionValue.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Uparkour_GP4SoakBotSubsystem
+
+bool Uparkour_GP4SoakBotSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer) || !FParse::Param(FCommandLine::Get(), TEXT("ParkourBot")))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void Uparkour_GP4SoakBotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Every bot process gets its own seed so the clients do not all move in lockstep.
+	int32 Seed = static_cast<int32>(FPlatformProcess::GetCurrentProcessId());
+	FParse::Value(FCommandLine::Get(), TEXT("ParkourBotSeed="), Seed);
+	Random.Initialize(Seed);
+
+	PickNewHeading();
+}
+
+Aparkour_GP4Character* Uparkour_GP4SoakBotSubsystem::GetBotCharacter() const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr || !PlayerController->IsLocalController())
+	{
+		return nullptr;
+	}
+
+	return Cast<Aparkour_GP4Character>(PlayerController->GetPawn());
+}
+
+void Uparkour_GP4SoakBotSubsystem::PickNewHeading()
+{
+	TargetYaw = Random.FRandRange(-180.0f, 180.0f);
+	TimeUntilHeadingChange = Random.FRandRange(3.0f, 8.0f);
+}
+
+void Uparkour_GP4SoakBotSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (GetWorld()->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	Aparkour_GP4Character* Character = GetBotCharacter();
+	if (Character == nullptr)
+	{
+		return;
+	}
+
+	APlayerController* PlayerController = CastChecked<APlayerController>(Character->GetController());
+	UEnhancedInputLocalPlayerSubsystem* InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer());
+	if (InputSubsystem == nullptr)
+	{
+		return;
+	}
+
+	// Steer towards the current heading, picking a new one every few seconds.
+	TimeUntilHeadingChange -= DeltaTime;
+	if (TimeUntilHeadingChange <= 0.0f)
+	{
+		PickNewHeading();
+	}
+	const FRotator ControlRotation = PlayerController->GetControlRotation();
+	const float NewYaw = FMath::FixedTurn(ControlRotation.Yaw, TargetYaw, 90.0f * DeltaTime);
+	PlayerController->SetControlRotation(FRotator(0.0f, NewYaw, 0.0f));
+
+	InputSubsystem->InjectInputForAction(Character->GetMoveAction(), FInputActionValue(FVector2D(0.0f, 1.0f)));
+
+	// Hold sprint most of the time and let go every now and then so the run to stop path is hit as well.
+	TimeUntilSprintToggle -= DeltaTime;
+	if (TimeUntilSprintToggle <= 0.0f)
+	{
+		bWantsSprint = !bWantsSprint;
+		TimeUntilSprintToggle = bWantsSprint ? Random.FRandRange(4.0f, 10.0f) : Random.FRandRange(0.5f, 2.0f);
+	}
+	if (bWantsSprint)
+	{
+		InputSubsystem->InjectInputForAction(Character->GetSprintAction(), FInputActionValue(true));
+	}
+
+	TimeUntilSlide -= DeltaTime;
+	if (TimeUntilSlide <= 0.0f && Character->GetVelocity().Size() > 450.0f)
+	{
+		InputSubsystem->InjectInputForAction(Character->GetSlideAction(), FInputActionValue(true));
+		TimeUntilSlide = Random.FRandRange(2.0f, 6.0f);
+	}
+
+	// Jump whenever something is in front of us, the character Blueprint decides between vaulting and mantling.
+	TimeUntilJump -= DeltaTime;
+	if (TimeUntilJump <= 0.0f)
+	{
+		const FVector Start = Character->GetActorLocation();
+		const FVector End = Start + Character->GetActorForwardVector() * 150.0f;
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ParkourSoakBot), false, Character);
+
+		if (GetWorld()->LineTraceTestByChannel(Start, End, ECC_Visibility, QueryParams))
+		{
+			InputSubsystem->InjectInputForAction(Character->GetJumpAction(), FInputActionValue(true));
+			TimeUntilJump = 1.0f;
+		}
+	}
+}
+
+TStatId Uparkour_GP4SoakBotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(Uparkour_GP4SoakBotSubsystem, STATGROUP_Tickables);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Uparkour_GP4SoakStatsSubsystem
+
+bool Uparkour_GP4SoakStatsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer) || !FParse::Param(FCommandLine::Get(), TEXT("ParkourSoakStats")))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void Uparkour_GP4SoakStatsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("ParkourSoakCsv="), CsvPath))
+	{
+		CsvPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("ParkourSoak") / FString::Printf(TEXT("Soak-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	const FString Header = TEXT("Seconds,Clients,Characters,AvgWorldTickMs,MaxWorldTickMs,AvgFrameMs,InBytesPerSec,OutBytesPerSec,CorrectionsPerSec,TraversalChainsPerSec,ChainsSkippedPerSec,PrefilterQueriesPerSec,TracesAvoidedPerSec,AvgNetUpdateHz,TraversalTierCharacters,CourseCulledPerSec\n");
+	FFileHelper::SaveStringToFile(Header, *CsvPath);
+	UE_LOG(LogTemp, Log, TEXT("Parkour soak stats are written to %s"), *CsvPath);
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &Uparkour_GP4SoakStatsSubsystem::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &Uparkour_GP4SoakStatsSubsystem::OnWorldPostActorTick);
+	SampleStartTime = FPlatformTime::Seconds();
+	LastChainsRun = FParkourTraversalPrefilter::GetTotalChainsRun();
+	LastChainsSkipped = FParkourTraversalPrefilter::GetTotalChainsSkipped();
+	LastPrefilterQueries = FParkourTraversalPrefilter::GetTotalOverlapQueries();
+	LastCourseCulled = Uparkour_GP4NetRateSubsystem::GetTotalCourseCulled();
+}
+
+void Uparkour_GP4SoakStatsSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+void Uparkour_GP4SoakStatsSubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld())
+	{
+		WorldTickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void Uparkour_GP4SoakStatsSubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld == GetWorld() && WorldTickStartTime > 0.0)
+	{
+		const double WorldTickSeconds = FPlatformTime::Seconds() - WorldTickStartTime;
+		WorldTickSecondsSum += WorldTickSeconds;
+		WorldTickSecondsMax = FMath::Max(WorldTickSecondsMax, WorldTickSeconds);
+	}
+}
+
+void Uparkour_GP4SoakStatsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FrameSecondsSum += DeltaTime;
+	FrameCount++;
+
+	if (FPlatformTime::Seconds() - SampleStartTime >= 1.0)
+	{
+		WriteSample();
+	}
+}
+
+void Uparkour_GP4SoakStatsSubsystem::WriteSample()
+{
+	UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	const double Now = FPlatformTime::Seconds();
+	const double SampleSeconds = Now - SampleStartTime;
+
+	int32 Characters = 0;
+	int32 Corrections = 0;
+	int32 TraversalTierCharacters = 0;
+	float NetUpdateFrequencySum = 0.0f;
+	for (TActorIterator<Aparkour_GP4Character> It(World); It; ++It)
+	{
+		Characters++;
+		NetUpdateFrequencySum += It->NetUpdateFrequency;
+		TraversalTierCharacters += Uparkour_GP4NetRateSubsystem::GetTier(*It) == EParkourNetRateTier::Traversal ? 1 : 0;
+		if (Uparkour_GP4MovementComponent* MovementComponent = Cast<Uparkour_GP4MovementComponent>(It->GetCharacterMovement()))
+		{
+			Corrections += MovementComponent->ConsumeServerCorrections();
+		}
+	}
+
+	// A skipped chain saves its obstacle trace, every chain stops there when nothing is in reach. The overlap queries are the price for that.
+	const uint64 ChainsRun = FParkourTraversalPrefilter::GetTotalChainsRun() - LastChainsRun;
+	const uint64 ChainsSkipped = FParkourTraversalPrefilter::GetTotalChainsSkipped() - LastChainsSkipped;
+	const uint64 PrefilterQueries = FParkourTraversalPrefilter::GetTotalOverlapQueries() - LastPrefilterQueries;
+	LastChainsRun += ChainsRun;
+	LastChainsSkipped += ChainsSkipped;
+	LastPrefilterQueries += PrefilterQueries;
+
+	const uint64 CourseCulled = Uparkour_GP4NetRateSubsystem::GetTotalCourseCulled() - LastCourseCulled;
+	LastCourseCulled += CourseCulled;
+
+	// Without a course nothing is culled, and a comparison of two runs would only show the rate tiers.
+	const Uparkour_GP4NetRateSubsystem* NetRate = World->GetSubsystem<Uparkour_GP4NetRateSubsystem>();
+	if (!bWarnedNoCourse && NetRate && !NetRate->HasCourse() && Uparkour_GP4NetRateSubsystem::IsEnabled())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no Aparkour_GP4Course, characters are not culled along the course in this soak run"), *World->GetMapName());
+		bWarnedNoCourse = true;
+	}
+
+	const FString Row = FString::Printf(TEXT("%.1f,%d,%d,%.3f,%.3f,%.3f,%u,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%d,%.1f\n"),
+		World->GetTimeSeconds(),
+		NetDriver ? NetDriver->ClientConnections.Num() : 0,
+		Characters,
+		FrameCount > 0 ? WorldTickSecondsSum * 1000.0 / FrameCount : 0.0,
+		WorldTickSecondsMax * 1000.0,
+		FrameCount > 0 ? FrameSecondsSum * 1000.0 / FrameCount : 0.0,
+		NetDriver ? NetDriver->InBytesPerSecond : 0,
+		NetDriver ? NetDriver->OutBytesPerSecond : 0,
+		Corrections / SampleSeconds,
+		(ChainsRun + ChainsSkipped) / SampleSeconds,
+		ChainsSkipped / SampleSeconds,
+		PrefilterQueries / SampleSeconds,
+		(static_cast<double>(ChainsSkipped) - static_cast<double>(PrefilterQueries)) / SampleSeconds,
+		Characters > 0 ? NetUpdateFrequencySum / Characters : 0.0f,
+		TraversalTierCharacters,
+		CourseCulled / SampleSeconds);
+	FFileHelper::SaveStringToFile(Row, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	SampleStartTime = Now;
+	WorldTickSecondsSum = 0.0;
+	WorldTickSecondsMax = 0.0;
+	FrameSecondsSum = 0.0;
+	FrameCount = 0;
+}
+
+TStatId Uparkour_GP4SoakStatsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(Uparkour_GP4SoakStatsSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "parkour_GP4SoakTest.generated.h"
+
+class Aparkour_GP4Character;
+
+/**
+ * Drives the locally controlled parkour character like a player would when the game is started with -ParkourBot.
+ * Sprinting, sliding and jumping are injected through the character's input actions so the same
+ * Blueprint vault/mantle path and server RPCs are exercised as for a real client.
+ */
+UCLASS()
+class Uparkour_GP4SoakBotSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	Aparkour_GP4Character* GetBotCharacter() const;
+	void PickNewHeading();
+
+	FRandomStream Random;
+	float TargetYaw = 0.0f;
+	float TimeUntilHeadingChange = 0.0f;
+	float TimeUntilSprintToggle = 0.0f;
+	float TimeUntilSlide = 0.0f;
+	float TimeUntilJump = 0.0f;
+	bool bWantsSprint = true;
+};
+
+/**
+ * Server side recorder for soak tests, enabled with -ParkourSoakStats.
+ * Writes one CSV row per second with world tick time, bandwidth, movement corrections, the work saved by the
+ * traversal prefilter and the adaptive replication rates, so a run with a growing number of bots gives a capacity curve.
+ */
+UCLASS()
+class Uparkour_GP4SoakStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+	void WriteSample();
+
+	FString CsvPath;
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+
+	double WorldTickStartTime = 0.0;
+	double SampleStartTime = 0.0;
+	double WorldTickSecondsSum = 0.0;
+	double WorldTickSecondsMax = 0.0;
+	double FrameSecondsSum = 0.0;
+	int32 FrameCount = 0;
+
+	// FParkourTraversalPrefilter totals at the last sample.
+	uint64 LastChainsRun = 0;
+	uint64 LastChainsSkipped = 0;
+	uint64 LastPrefilterQueries = 0;
+
+	// Uparkour_GP4NetRateSubsystem total at the last sample.
+	uint64 LastCourseCulled = 0;
+	bool bWarnedNoCourse = false;
+};
@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4StressCourse.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SplineComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Crc.h"
+#include "UObject/ConstructorHelpers.h"
+
+Aparkour_GP4StressCourse::Aparkour_GP4StressCourse()
+{
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> CubeMeshFinder(TEXT("/Game/LevelPrototyping/Meshes/SM_Cube"));
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> RampMeshFinder(TEXT("/Game/LevelPrototyping/Meshes/SM_Ramp"));
+	CubeMesh = CubeMeshFinder.Object;
+	RampMesh = RampMeshFinder.Object;
+
+	// Spawned into a map that has its own course, the culling keeps using that one.
+	bReplaceExistingCourse = false;
+
+	auto CreateInstances = [this](FName Name)
+	{
+		UInstancedStaticMeshComponent* Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(Name);
+		Instances->SetupAttachment(RootComponent);
+		Instances->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		return Instances;
+	};
+	FloorInstances = CreateInstances(TEXT("Floors"));
+	VaultInstances = CreateInstances(TEXT("Vaults"));
+	MantleInstances = CreateInstances(TEXT("Mantles"));
+	RampInstances = CreateInstances(TEXT("SlideRamps"));
+	CeilingInstances = CreateInstances(TEXT("LowCeilings"));
+}
+
+void Aparkour_GP4StressCourse::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	Generate();
+}
+
+FTransform Aparkour_GP4StressCourse::MakeInstanceTransform(const UStaticMesh* Mesh, const FVector& Base, const FVector& Size, float Yaw)
+{
+	// The LevelPrototyping meshes do not share a pivot, so everything is placed by the mesh bounds.
+	const FBox Bounds = Mesh->GetBoundingBox();
+	const FVector Scale = Size / Bounds.GetSize().ComponentMax(FVector(KINDA_SMALL_NUMBER));
+	const FVector BoundsBottom(Bounds.GetCenter().X, Bounds.GetCenter().Y, Bounds.Min.Z);
+
+	const FQuat Rotation(FRotator(0.0f, Yaw, 0.0f));
+	return FTransform(Rotation, Base - Rotation.RotateVector(BoundsBottom * Scale), Scale);
+}
+
+/// <summary>
+/// Lane L runs along +X for even L and back along -X for odd L, so the spline goes up one lane, across and down the next.
+/// Every section draws its feature and sizes from one random stream in a fixed order, which keeps the layout the same for the same Seed.
+/// The feature sits in the middle of its section, the rest of the section is run up and landing space.
+/// </summary>
+void Aparkour_GP4StressCourse::Generate()
+{
+	UInstancedStaticMeshComponent* const AllInstances[] = { FloorInstances, VaultInstances, MantleInstances, RampInstances, CeilingInstances };
+	for (UInstancedStaticMeshComponent* Instances : AllInstances)
+	{
+		Instances->ClearInstances();
+	}
+	Spline->ClearSplinePoints(false);
+	FMemory::Memzero(FeatureCounts);
+
+	if (CubeMesh == nullptr || RampMesh == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Stress course %s has no cube or ramp mesh, nothing generated"), *GetName());
+		Spline->UpdateSpline();
+		return;
+	}
+
+	FloorInstances->SetStaticMesh(CubeMesh);
+	VaultInstances->SetStaticMesh(CubeMesh);
+	MantleInstances->SetStaticMesh(CubeMesh);
+	RampInstances->SetStaticMesh(RampMesh);
+	CeilingInstances->SetStaticMesh(CubeMesh);
+
+	FRandomStream Random(Seed);
+	const int32 NumFeatures = static_cast<int32>(EParkourStressFeature::Num);
+	const float Weights[NumFeatures] = { VaultWeight, MantleWeight, SlideRampWeight, LowCeilingWeight };
+	float TotalWeight = 0.0f;
+	for (const float Weight : Weights)
+	{
+		TotalWeight += FMath::Max(Weight, 0.0f);
+	}
+
+	auto RandRange = [&Random](const FVector2D& Range)
+	{
+		return Random.FRandRange(Range.X, Range.Y);
+	};
+
+	TArray<FTransform> Floors, Vaults, Mantles, Ramps, Ceilings;
+	const float LaneLength = SectionsPerLane * SectionLength;
+	const float FeatureWidth = LaneWidth * 0.6f;
+
+	for (int32 Lane = 0; Lane < Lanes; Lane++)
+	{
+		const float LaneY = Lane * LaneWidth;
+		const bool bForward = Lane % 2 == 0;
+		const float Direction = bForward ? 1.0f : -1.0f;
+		const float LaneYaw = bForward ? 0.0f : 180.0f;
+
+		Floors.Add(MakeInstanceTransform(CubeMesh, FVector(LaneLength * 0.5f, LaneY, -50.0f), FVector(LaneLength, LaneWidth, 50.0f), 0.0f));
+
+		const float StartX = bForward ? 0.0f : LaneLength;
+		Spline->AddSplinePoint(FVector(StartX, LaneY, 0.0f), ESplineCoordinateSpace::Local, false);
+		Spline->AddSplinePoint(FVector(LaneLength - StartX, LaneY, 0.0f), ESplineCoordinateSpace::Local, false);
+
+		for (int32 Section = 0; Section < SectionsPerLane; Section++)
+		{
+			const float SectionCenter = StartX + Direction * (Section + 0.5f) * SectionLength;
+			const FVector Base(SectionCenter, LaneY, 0.0f);
+
+			float Pick = Random.FRandRange(0.0f, TotalWeight);
+			int32 FeatureIndex = 0;
+			while (FeatureIndex < NumFeatures - 1 && Pick >= FMath::Max(Weights[FeatureIndex], 0.0f))
+			{
+				Pick -= FMath::Max(Weights[FeatureIndex], 0.0f);
+				FeatureIndex++;
+			}
+			FeatureCounts[FeatureIndex]++;
+
+			switch (static_cast<EParkourStressFeature>(FeatureIndex))
+			{
+			case EParkourStressFeature::Vault:
+			{
+				const float Depth = RandRange(VaultDepth);
+				const float Height = RandRange(VaultHeight);
+				Vaults.Add(MakeInstanceTransform(CubeMesh, Base, FVector(Depth, FeatureWidth, Height), LaneYaw));
+				break;
+			}
+			case EParkourStressFeature::Mantle:
+			{
+				const float Depth = RandRange(MantleDepth);
+				const float Height = RandRange(MantleHeight);
+				Mantles.Add(MakeInstanceTransform(CubeMesh, Base, FVector(Depth, FeatureWidth, Height), LaneYaw));
+				break;
+			}
+			case EParkourStressFeature::SlideRamp:
+			{
+				// Half the ramps rise along the run and half fall, so IsSlopeUp sees both.
+				const float Length = RandRange(RampLength);
+				const float Height = RandRange(RampHeight);
+				const bool bRising = Random.FRand() < 0.5f;
+				Ramps.Add(MakeInstanceTransform(RampMesh, Base, FVector(Length, LaneWidth, Height), bRising ? LaneYaw : LaneYaw + 180.0f));
+				break;
+			}
+			case EParkourStressFeature::LowCeiling:
+			{
+				const float Clearance = RandRange(CeilingClearance);
+				const float Depth = RandRange(CeilingDepth);
+				Ceilings.Add(MakeInstanceTransform(CubeMesh, Base + FVector(0.0f, 0.0f, Clearance), FVector(Depth, LaneWidth, 40.0f), LaneYaw));
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	}
+
+	FloorInstances->AddInstances(Floors, false);
+	VaultInstances->AddInstances(Vaults, false);
+	MantleInstances->AddInstances(Mantles, false);
+	RampInstances->AddInstances(Ramps, false);
+	CeilingInstances->AddInstances(Ceilings, false);
+
+	for (int32 PointIndex = 0; PointIndex < Spline->GetNumberOfSplinePoints(); PointIndex++)
+	{
+		Spline->SetSplinePointType(PointIndex, ESplinePointType::Linear, false);
+	}
+	Spline->UpdateSpline();
+}
+
+uint32 Aparkour_GP4StressCourse::GetLayoutHash() const
+{
+	uint32 Crc = 0;
+	const UInstancedStaticMeshComponent* const AllInstances[] = { FloorInstances, VaultInstances, MantleInstances, RampInstances, CeilingInstances };
+	for (const UInstancedStaticMeshComponent* Instances : AllInstances)
+	{
+		for (int32 InstanceIndex = 0; InstanceIndex < Instances->GetInstanceCount(); InstanceIndex++)
+		{
+			FTransform Transform;
+			Instances->GetInstanceTransform(InstanceIndex, Transform, false);
+
+			const FVector Location = Transform.GetLocation();
+			const FVector Scale = Transform.GetScale3D();
+			const FQuat Rotation = Transform.GetRotation();
+			Crc = FCrc::MemCrc32(&Location, sizeof(Location), Crc);
+			Crc = FCrc::MemCrc32(&Scale, sizeof(Scale), Crc);
+			Crc = FCrc::MemCrc32(&Rotation, sizeof(Rotation), Crc);
+		}
+	}
+	return Crc;
+}
+
+#if !UE_BUILD_SHIPPING
+
+/// <summary>
+/// Spawns a stress course at the local player's feet, or at the world origin without one, and logs what it generated.
+/// Running it twice with the same arguments logs the same layout hash.
+/// </summary>
+static FAutoConsoleCommandWithWorldAndArgs StressCourseSpawnCommand(
+	TEXT("parkour.StressCourse.Spawn"),
+	TEXT("Generates a stress course. Usage: parkour.StressCourse.Spawn [Seed=1] [Lanes=8] [SectionsPerLane=250]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		FTransform SpawnTransform = FTransform::Identity;
+		const APlayerController* PlayerController = World->GetFirstPlayerController();
+		if (const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+		{
+			SpawnTransform.SetLocation(Pawn->GetActorLocation() - FVector(0.0f, 0.0f, Pawn->GetSimpleCollisionHalfHeight()));
+		}
+
+		Aparkour_GP4StressCourse* Course = World->SpawnActorDeferred<Aparkour_GP4StressCourse>(Aparkour_GP4StressCourse::StaticClass(), SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		Course->Seed = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1;
+		Course->Lanes = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : Course->Lanes;
+		Course->SectionsPerLane = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : Course->SectionsPerLane;
+		Course->FinishSpawning(SpawnTransform);
+
+		UE_LOG(LogTemp, Display, TEXT("Stress course %s seed %d: %d vaults, %d mantles, %d slide ramps, %d low ceilings, layout hash %08x"),
+			*Course->GetName(), Course->Seed,
+			Course->GetNumFeatures(EParkourStressFeature::Vault), Course->GetNumFeatures(EParkourStressFeature::Mantle),
+			Course->GetNumFeatures(EParkourStressFeature::SlideRamp), Course->GetNumFeatures(EParkourStressFeature::LowCeiling),
+			Course->GetLayoutHash());
+	}));
+
+static FAutoConsoleCommandWithWorld StressCourseClearCommand(
+	TEXT("parkour.StressCourse.Clear"),
+	TEXT("Destroys every stress course in the world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		for (TActorIterator<Aparkour_GP4StressCourse> It(World); It; ++It)
+		{
+			It->Destroy();
+		}
+	}));
+
+#endif
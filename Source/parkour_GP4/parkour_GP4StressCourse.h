@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "parkour_GP4Course.h"
+#include "parkour_GP4StressCourse.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/** What the stress course put into one section of a lane. */
+UENUM()
+enum class EParkourStressFeature : uint8
+{
+	Vault,
+	Mantle,
+	SlideRamp,
+	LowCeiling,
+	Num UMETA(Hidden)
+};
+
+/**
+ * Large generated course for traversal benchmarks, the same layout for the same Seed every time.
+ * Lanes side by side run in alternating directions so the course snakes back and forth. Every section of a lane holds one feature:
+ * a box of random depth to vault over, a ledge to mantle onto, a ramp to slide up or down, or a low ceiling to slide under.
+ * Depths and heights are drawn from ranges that reach past what the traces accept, so the blocked branches are hit as well.
+ * Each kind of feature is one instanced static mesh, the course spline follows the lanes for the net rate course culling.
+ * The spline is only used for the culling while the map has no course of its own.
+ *
+ * Place one in a map, or spawn one at runtime with parkour.StressCourse.Spawn [Seed] [Lanes] [SectionsPerLane].
+ * The traversal simulator runs on one with -StressCourse=Seed.
+ */
+UCLASS()
+class Aparkour_GP4StressCourse : public Aparkour_GP4Course
+{
+	GENERATED_BODY()
+
+public:
+	Aparkour_GP4StressCourse();
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** Clears the instances and the spline and builds the course for the current settings. */
+	void Generate();
+
+	/** CRC of every instance transform, equal for two courses generated with the same settings. */
+	uint32 GetLayoutHash() const;
+
+	int32 GetNumFeatures(EParkourStressFeature Feature) const { return FeatureCounts[static_cast<int32>(Feature)]; }
+
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		int32 Seed = 1;
+
+	UPROPERTY(EditAnywhere, Category = "Stress Course", meta = (ClampMin = 1))
+		int32 Lanes = 8;
+
+	UPROPERTY(EditAnywhere, Category = "Stress Course", meta = (ClampMin = 1))
+		int32 SectionsPerLane = 250;
+
+	/** Length of one section along the lane, every feature fits inside it with room to run up. */
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		float SectionLength = 1200.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		float LaneWidth = 600.0f;
+
+	/** Relative chance of each feature, in EParkourStressFeature order. */
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		float VaultWeight = 0.45f;
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		float MantleWeight = 0.25f;
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		float SlideRampWeight = 0.15f;
+	UPROPERTY(EditAnywhere, Category = "Stress Course")
+		float LowCeilingWeight = 0.15f;
+
+	/** Depth and height ranges in cm, X is the minimum and Y the maximum. */
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Vault")
+		FVector2D VaultDepth = FVector2D(20.0f, 400.0f);
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Vault")
+		FVector2D VaultHeight = FVector2D(40.0f, 130.0f);
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Mantle")
+		FVector2D MantleDepth = FVector2D(100.0f, 400.0f);
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Mantle")
+		FVector2D MantleHeight = FVector2D(120.0f, 280.0f);
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Slide")
+		FVector2D RampLength = FVector2D(300.0f, 800.0f);
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Slide")
+		FVector2D RampHeight = FVector2D(40.0f, 250.0f);
+	/** Clearance below the ceiling slab, around the crouched capsule height so both outcomes of TraceForCeiling come up. */
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Slide")
+		FVector2D CeilingClearance = FVector2D(90.0f, 160.0f);
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Slide")
+		FVector2D CeilingDepth = FVector2D(200.0f, 600.0f);
+
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Meshes")
+		UStaticMesh* CubeMesh;
+	/** Has to rise along its X axis. */
+	UPROPERTY(EditAnywhere, Category = "Stress Course|Meshes")
+		UStaticMesh* RampMesh;
+
+private:
+	/** Transform that scales and places Mesh so its bounds fill a box of Size with the bottom centre at Base, turned by Yaw. */
+	static FTransform MakeInstanceTransform(const UStaticMesh* Mesh, const FVector& Base, const FVector& Size, float Yaw);
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress Course")
+		UInstancedStaticMeshComponent* FloorInstances;
+	UPROPERTY(VisibleAnywhere, Category = "Stress Course")
+		UInstancedStaticMeshComponent* VaultInstances;
+	UPROPERTY(VisibleAnywhere, Category = "Stress Course")
+		UInstancedStaticMeshComponent* MantleInstances;
+	UPROPERTY(VisibleAnywhere, Category = "Stress Course")
+		UInstancedStaticMeshComponent* RampInstances;
+	UPROPERTY(VisibleAnywhere, Category = "Stress Course")
+		UInstancedStaticMeshComponent* CeilingInstances;
+
+	int32 FeatureCounts[static_cast<int32>(EParkourStressFeature::Num)] = {};
+};
@@ -0,0 +1,420 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalQueries.h"
+#include "Kismet/KismetMathLibrary.h"
+
+static void AnalyzeVaultBisection(FParkourTraversalQueries& Queries, const FParkourVaultParams& Params, const FVector& Origin, const FVector& Forward, FParkourVaultResult& Result);
+
+bool ParkourTraversal::ShouldVault(float Speed, bool bIsFalling)
+{
+	return Speed > MinVaultSpeed && !bIsFalling;
+}
+
+void ParkourTraversal::AnalyzeVault(FParkourTraversalQueries& Queries, const FParkourVaultParams& Params, const FVector& Origin, const FVector& Forward, FParkourVaultResult& Result)
+{
+	Result.bVaultFound = false;
+	if (Params.bBisectDepth)
+	{
+		AnalyzeVaultBisection(Queries, Params, Origin, Forward, Result);
+		return;
+	}
+
+	/*
+		Do a line trace to trace for the object to vault over. If an object is found, the script continues to find the target locations.
+		Vault distance is set to 0 so it can be incremented to find the vaulting distance and play different montages based on it.
+	*/
+
+	FVector StartVector = Origin;
+
+	FVector MultipliedVector = Forward * Params.InitialTraceLength;
+
+	FVector EndVector = Origin + MultipliedVector;
+
+	FHitResult OutHit;
+	FParkourIgnoreActors ActorsArray;
+	//EDrawDebugTrace::Type DrawDebugType = EDrawDebugTrace::ForDuration;
+	bool bSingleHit = Queries.LineTrace(TEXT("VaultTrace.Obstacle"), StartVector, EndVector, ActorsArray, OutHit);
+
+	if (bSingleHit)
+	{
+		Result.VaultDistance = 0;
+		for (int i = 0; i < Params.MaxDepthSteps; i++)
+		{
+			/*
+			* Sphere Traces used to determine the length of the object and height.
+			*/
+
+			Result.VaultDistance++;
+			FVector MultiVector = Forward * i * Params.SecondaryTraceGap;
+			FVector EndHitLocation = OutHit.Location + MultiVector;
+			FVector AddedVector = EndHitLocation;
+			AddedVector.Z += Params.SecondaryTraceZOffset;
+			FParkourIgnoreActors ActorsArray2;
+			FHitResult OutHit2;
+
+			bool bSphereHit = Queries.SphereTrace(TEXT("VaultTrace.Depth"), AddedVector, EndHitLocation, 10.0f, ActorsArray2, OutHit2, true);
+
+			if (bSphereHit)
+			{
+				if (i == 0)
+				{
+					/*
+					* If it is the first/initial trace then the vault starting location is set and a sphere trace is used to check if there is anything blocking so the vault can be cancelled if there is.
+					*/
+
+					Result.VaultStartLocation = OutHit2.ImpactPoint;
+					FVector AddToVaultStartVector = Result.VaultStartLocation;
+					AddToVaultStartVector.Z += 20.0f;
+
+					FParkourIgnoreActors ActorsArray3;
+					FHitResult OutHit3;
+
+					bool bSphereHit2 = Queries.SphereTrace(TEXT("VaultTrace.StartClearance"), AddToVaultStartVector, AddToVaultStartVector, 10.0f, ActorsArray3, OutHit3);
+					if (bSphereHit2)
+					{
+						Result.CanVault = false;
+						break;  // Not sure if Breaks For Loop or just statement
+					}
+				}
+				else
+				{
+
+					/*
+					* if the Trace is not the initial one then the vault middle/height location is set by setting it every time a trace is done, making the final trace the target middle location.
+					*/
+
+					Result.VaultMiddleLocation = OutHit2.ImpactPoint;
+					FParkourIgnoreActors ActorsArray4;
+					FHitResult OutHit4;
+
+					bool bSphereHit3 = Queries.SphereTrace(TEXT("VaultTrace.HeightClearance"), OutHit2.TraceStart, OutHit2.TraceStart, 10.0f, ActorsArray4, OutHit4);
+					if (bSphereHit3)
+					{
+						Result.CanVault = false;
+					}
+				}
+			}
+			else
+			{
+				Result.CanVault = true;
+
+				/*
+				* Find the landing location by doing a line trace downwards from an offset so it is not directly tracing down to the object but to the floor.
+				*/
+
+				FHitResult OutHit5;
+				FParkourIgnoreActors ActorsArray5;
+
+				FVector MultiplyForwardVector = Forward * Params.LandingPositionForwardOffset;
+
+				FVector StartTraceEndAddVector = OutHit2.TraceEnd + MultiplyForwardVector;
+
+				FVector EndTraceEndAddVector = StartTraceEndAddVector;
+				EndTraceEndAddVector.Z -= 100.0f;
+
+				bool bSingleHit4 = Queries.LineTrace(TEXT("VaultTrace.Land"), StartTraceEndAddVector, EndTraceEndAddVector, ActorsArray5, OutHit5);
+
+				FParkourIgnoreActors ActorsArray6;
+				FHitResult OutHit6;
+				bool bSphereHit5 = Queries.SphereTrace(TEXT("VaultTrace.LandClearance"), StartTraceEndAddVector, StartTraceEndAddVector, 20.0f, ActorsArray6, OutHit6);
+
+				if (bSphereHit5)
+				{
+					Result.CanVault = false;
+				}
+				else
+				{
+					Result.VaultLandLocation = OutHit5.Location;
+					Result.bVaultFound = true;
+
+				}
+
+				break;  // not sure if break out of for Loop and If this is correct or not. might not work.
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Same decision as the linear scan in AnalyzeVault, but the far side of the obstacle is found with a galloping search (steps 1, 2, 4, ...)
+/// that brackets the first depth probe that misses, followed by a bisection inside the bracket.
+/// The height clearance probes of the linear scan are skipped, their result is always overwritten once a probe misses.
+/// If no probe misses the obstacle is deeper than the search range. The linear scan then leaves CanVault as it was unless a height clearance probe hits,
+/// so only then are those probes run, and only while CanVault is still set.
+/// Assumes the top of the obstacle has no gaps, a gap between two probed steps can be skipped where the linear scan would land in it.
+/// </summary>
+static void AnalyzeVaultBisection(FParkourTraversalQueries& Queries, const FParkourVaultParams& Params, const FVector& Origin, const FVector& Forward, FParkourVaultResult& Result)
+{
+	FHitResult OutHit;
+	const FParkourIgnoreActors NoActorsToIgnore;
+	if (!Queries.LineTrace(TEXT("VaultTrace.Obstacle"), Origin, Origin + Forward * Params.InitialTraceLength, NoActorsToIgnore, OutHit))
+	{
+		return;
+	}
+
+	const int32 NumSteps = Params.MaxDepthSteps;
+	Result.VaultDistance = 0;
+	if (NumSteps <= 0)
+	{
+		return;
+	}
+
+	auto GetProbeEnd = [&](int32 Step)
+	{
+		return OutHit.Location + Forward * Step * Params.SecondaryTraceGap;
+	};
+
+	auto ProbeDepth = [&](int32 Step, FHitResult& OutProbeHit)
+	{
+		const FVector EndHitLocation = GetProbeEnd(Step);
+		const FVector ProbeStart = EndHitLocation + FVector(0.0f, 0.0f, Params.SecondaryTraceZOffset);
+		return Queries.SphereTrace(TEXT("VaultTrace.Depth"), ProbeStart, EndHitLocation, 10.0f, NoActorsToIgnore, OutProbeHit, true);
+	};
+
+	// The first probe finds the vault start, nothing can be in the way above it.
+	int32 MissStep = INDEX_NONE;
+	int32 LastHitStep = 0;
+	FHitResult LastHit;
+	FHitResult MissHit;
+
+	if (ProbeDepth(0, LastHit))
+	{
+		Result.VaultStartLocation = LastHit.ImpactPoint;
+
+		FHitResult ClearanceHit;
+		if (Queries.SphereTrace(TEXT("VaultTrace.StartClearance"), Result.VaultStartLocation + FVector(0.0f, 0.0f, 20.0f), Result.VaultStartLocation + FVector(0.0f, 0.0f, 20.0f), 10.0f, NoActorsToIgnore, ClearanceHit))
+		{
+			Result.VaultDistance = 1;
+			Result.CanVault = false;
+			return;
+		}
+
+		// Gallop until a probe misses, so the far side is between the last hit and that miss.
+		int32 Step = 1;
+		while (Step < NumSteps)
+		{
+			FHitResult ProbeHit;
+			if (!ProbeDepth(Step, ProbeHit))
+			{
+				MissStep = Step;
+				MissHit = ProbeHit;
+				break;
+			}
+
+			LastHitStep = Step;
+			LastHit = ProbeHit;
+			if (Step == NumSteps - 1)
+			{
+				break;
+			}
+			Step = FMath::Min(Step * 2, NumSteps - 1);
+		}
+
+		// Bisect the bracket down to the first step that misses.
+		if (MissStep != INDEX_NONE)
+		{
+			while (MissStep - LastHitStep > 1)
+			{
+				const int32 MidStep = (LastHitStep + MissStep) / 2;
+				FHitResult ProbeHit;
+				if (ProbeDepth(MidStep, ProbeHit))
+				{
+					LastHitStep = MidStep;
+					LastHit = ProbeHit;
+				}
+				else
+				{
+					MissStep = MidStep;
+					MissHit = ProbeHit;
+				}
+			}
+		}
+	}
+	else
+	{
+		MissStep = 0;
+		MissHit = LastHit;
+	}
+
+	if (LastHitStep > 0)
+	{
+		Result.VaultMiddleLocation = LastHit.ImpactPoint;
+	}
+
+	if (MissStep == INDEX_NONE)
+	{
+		Result.VaultDistance = NumSteps;
+		for (int32 Step = 1; Step < NumSteps && Result.CanVault; Step++)
+		{
+			const FVector ClearanceCenter = GetProbeEnd(Step) + FVector(0.0f, 0.0f, Params.SecondaryTraceZOffset);
+			FHitResult ClearanceHit;
+			if (Queries.SphereTrace(TEXT("VaultTrace.HeightClearance"), ClearanceCenter, ClearanceCenter, 10.0f, NoActorsToIgnore, ClearanceHit))
+			{
+				Result.CanVault = false;
+			}
+		}
+		return;
+	}
+
+	/*
+	* Find the landing location by doing a line trace downwards from an offset so it is not directly tracing down to the object but to the floor.
+	*/
+	Result.VaultDistance = MissStep + 1;
+	Result.CanVault = true;
+
+	const FVector LandTraceStart = MissHit.TraceEnd + Forward * Params.LandingPositionForwardOffset;
+	FHitResult LandHit;
+	Queries.LineTrace(TEXT("VaultTrace.Land"), LandTraceStart, LandTraceStart - FVector(0.0f, 0.0f, 100.0f), NoActorsToIgnore, LandHit);
+
+	FHitResult LandClearanceHit;
+	if (Queries.SphereTrace(TEXT("VaultTrace.LandClearance"), LandTraceStart, LandTraceStart, 20.0f, NoActorsToIgnore, LandClearanceHit))
+	{
+		Result.CanVault = false;
+	}
+	else
+	{
+		Result.VaultLandLocation = LandHit.Location;
+		Result.bVaultFound = true;
+	}
+}
+
+bool ParkourTraversal::VaultResultsMatch(const FParkourVaultResult& A, const FParkourVaultResult& B)
+{
+	if (A.CanVault != B.CanVault || A.VaultDistance != B.VaultDistance)
+	{
+		return false;
+	}
+
+	// Positions only matter for a vault that is going to happen.
+	return !A.CanVault
+		|| (A.VaultStartLocation.Equals(B.VaultStartLocation, 1.0f)
+			&& A.VaultMiddleLocation.Equals(B.VaultMiddleLocation, 1.0f)
+			&& A.VaultLandLocation.Equals(B.VaultLandLocation, 1.0f));
+}
+
+void ParkourTraversal::AnalyzeMantle(FParkourTraversalQueries& Queries, const FParkourMantleParams& Params, const FVector& Origin, const FVector& Forward, bool bIsFalling, FParkourMantleResult& Result)
+{
+	Result.CanMantle = false;
+
+	/*
+		Trace to check for an object.
+	*/
+
+	FVector StartVector = Origin;
+	FVector MultipliedVector = Forward * Params.InitialTraceLength;
+	FVector EndVector = Origin + MultipliedVector;
+
+	FHitResult OutHit;
+	FParkourIgnoreActors ActorsArray;
+	//EDrawDebugTrace::Type DrawDebugType = EDrawDebugTrace::ForDuration;
+	bool bSingleHit = Queries.LineTrace(TEXT("MantleTrace.Obstacle"), StartVector, EndVector, ActorsArray, OutHit);
+
+	if (bSingleHit)
+	{
+		/*
+			If an object is found then trace for the object height. If player is falling then the maximum reachable height is lowered.
+		*/
+
+		float SelectedFloat = UKismetMathLibrary::SelectFloat(Params.FallingHeightMultiplier, 1.0f, bIsFalling);
+		float Multiplingfloat = Params.SecondaryTraceZOffset * SelectedFloat;
+		FVector StartVectorForSphere = OutHit.Location;
+		StartVectorForSphere.Z += Multiplingfloat;
+
+		FParkourIgnoreActors ActorsArray2;
+		FHitResult OutHit2;
+
+		bool bSphereHit = Queries.SphereTrace(TEXT("MantleTrace.Ledge"), StartVectorForSphere, OutHit.Location, 10.0f, ActorsArray2, OutHit2, true);
+		if (bSphereHit)
+		{
+
+			/*
+				Find the positions to motion warp to using the detected points from the trace.
+			*/
+			Result.MantlePosition1 = OutHit2.ImpactPoint + (Forward * -50.0f);
+			Result.MantlePosition2 = (Forward * 120.0f) + OutHit2.ImpactPoint;
+
+
+			Result.CanMantle = true;
+
+			FVector VectorForSphereTrace = Result.MantlePosition2;
+			VectorForSphereTrace.Z += 20.0f;
+			FParkourIgnoreActors ActorsArray3;
+			FHitResult OutHit3;
+
+			/*
+				Do a sphere trace to check if the player has enough space to land at the target location once mantled. This deduces the second motion warp location.
+			*/
+			bool bSphereHit2 = Queries.SphereTrace(TEXT("MantleTrace.LandClearance"), VectorForSphereTrace, VectorForSphereTrace, 10.0f, ActorsArray3, OutHit3);
+			if (bSphereHit2)
+			{
+				Result.CanMantle = false;
+
+				if (Result.MantlePosition1 == FVector(0.0f, 0.0f, 0.0f) || Result.MantlePosition2 == FVector(0.0f, 0.0f, 0.0f))
+				{
+					Result.CanMantle = false;
+				}
+				else
+				{
+					FVector EndVectorForSphere4 = Result.MantlePosition2;
+					EndVectorForSphere4.Z += 100.0f;
+					FVector MakeVectorMantle1(Result.MantlePosition1.X, Result.MantlePosition1.Y, EndVectorForSphere4.Z);
+
+					FParkourIgnoreActors ActorsArray4;
+					FHitResult OutHit4;
+					/*
+						Do a final trace to check if the path from the first and second mantle position is clear.
+					*/
+					bool bSphereHit3 = Queries.SphereTrace(TEXT("MantleTrace.Path"), MakeVectorMantle1, EndVectorForSphere4, 20.0f, ActorsArray4, OutHit4);
+
+					if (bSphereHit3)
+					{
+						Result.CanMantle = false;
+						// return mantle1Pos and mantle2Pos
+					}
+					else
+					{
+						// return mantle1Pos and mantle2Pos
+					}
+				}
+			}
+			else
+			{
+				Result.MantlePosition2 = (Forward * 50.0f) + OutHit2.ImpactPoint;
+
+				if (Result.MantlePosition1 == FVector(0.0f, 0.0f, 0.0f) || Result.MantlePosition2 == FVector(0.0f, 0.0f, 0.0f))
+				{
+					Result.CanMantle = false;
+				}
+				else
+				{
+					FVector EndVectorForSphere5 = Result.MantlePosition2;
+					EndVectorForSphere5.Z += 100.0f;
+					FVector MakeVectorMantle1_2(Result.MantlePosition1.X, Result.MantlePosition1.Y, EndVectorForSphere5.Z);
+
+					FParkourIgnoreActors ActorsArray4;
+					FHitResult OutHit4;
+					/*
+						Do a final trace to check if the path from the first and second mantle position is clear.
+					*/
+					bool bSphereHit3 = Queries.SphereTrace(TEXT("MantleTrace.Path"), MakeVectorMantle1_2, EndVectorForSphere5, 20.0f, ActorsArray4, OutHit4);
+
+					if (bSphereHit3)
+					{
+						Result.CanMantle = false;
+						// return mantle1Pos and mantle2Pos
+					}
+					else
+					{
+						// return mantle1Pos and mantle2Pos
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		Result.CanMantle = false;
+
+	}
+}
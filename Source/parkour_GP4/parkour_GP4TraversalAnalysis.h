@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "parkour_GP4TraversalAnalysis.generated.h"
+
+class FParkourTraversalQueries;
+
+UENUM(BlueprintType)
+enum class EParkourTraversalType : uint8
+{
+	Vault,
+	Mantle
+};
+
+/** Traversal events a character goes through, stored in ghost runs and hitch captures. */
+UENUM(BlueprintType)
+enum class EParkourTraversalEvent : uint8
+{
+	SlideStart,
+	SlideEnd,
+	Vault,
+	Mantle,
+	SprintStop
+};
+
+/** Inputs of the vault analysis, these are the values the character Blueprint passes to VaultTrace. */
+USTRUCT(BlueprintType)
+struct FParkourVaultParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float InitialTraceLength = 180.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float SecondaryTraceZOffset = 100.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float SecondaryTraceGap = 30.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float LandingPositionForwardOffset = 60.0f;
+	/** Maximum number of SecondaryTraceGap steps probed to find the far side of the obstacle. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		int MaxDepthSteps = 10;
+	/** Find the far side with a galloping search and bisection instead of probing every step. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		bool bBisectDepth = true;
+};
+
+USTRUCT(BlueprintType)
+struct FParkourVaultResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		FVector VaultStartLocation = FVector::ZeroVector;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		FVector VaultMiddleLocation = FVector::ZeroVector;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		FVector VaultLandLocation = FVector::ZeroVector;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		int VaultDistance = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		bool CanVault = false;
+	/** Set only when this analysis found a vault, CanVault can be left over from an earlier one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		bool bVaultFound = false;
+};
+
+/** Inputs of the mantle analysis, these are the values the character Blueprint passes to MantleTrace. */
+USTRUCT(BlueprintType)
+struct FParkourMantleParams
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float InitialTraceLength = 150.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float SecondaryTraceZOffset = 200.0f;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		float FallingHeightMultiplier = 0.5f;
+};
+
+USTRUCT(BlueprintType)
+struct FParkourMantleResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		FVector MantlePosition1 = FVector::ZeroVector;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		FVector MantlePosition2 = FVector::ZeroVector;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Movement)
+		bool CanMantle = false;
+};
+
+/**
+ * The vault and mantle decisions, independent of a character so offline tools can run the exact same traces.
+ * Origin and Forward are the actor location and forward vector of the character that would do the traversal.
+ * Results are updated in place, fields a trace chain does not reach keep their previous value like on the character.
+ */
+namespace ParkourTraversal
+{
+	/** Ground speed above which a character tries a vault, slower or falling characters try a mantle. */
+	constexpr float MinVaultSpeed = 450.0f;
+
+	/** The choice Vaulting() makes for the character Blueprint, before either trace chain runs. */
+	bool ShouldVault(float Speed, bool bIsFalling);
+
+	void AnalyzeVault(FParkourTraversalQueries& Queries, const FParkourVaultParams& Params, const FVector& Origin, const FVector& Forward, FParkourVaultResult& Result);
+
+	/** True if both vault results would make the character do the same vault. */
+	bool VaultResultsMatch(const FParkourVaultResult& A, const FParkourVaultResult& B);
+	void AnalyzeMantle(FParkourTraversalQueries& Queries, const FParkourMantleParams& Params, const FVector& Origin, const FVector& Forward, bool bIsFalling, FParkourMantleResult& Result);
+}
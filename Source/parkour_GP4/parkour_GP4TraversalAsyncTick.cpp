@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalAsyncTick.h"
+
+/// <summary>
+/// Carries the countdowns and sprint states over to the new snapshot. The characters normally come in the same order as last time,
+/// only when that changed are they matched up by pointer.
+/// </summary>
+void FParkourTraversalAsyncCallback::ConsumeInput(const FParkourTraversalAsyncInput& Input)
+{
+	bool bSameOrder = Input.Characters.Num() == Inputs.Num();
+	for (int32 Index = 0; bSameOrder && Index < Inputs.Num(); Index++)
+	{
+		bSameOrder = Input.Characters[Index].Character == Inputs[Index].Character;
+	}
+
+	if (!bSameOrder)
+	{
+		PreviousIndices.Reset();
+		for (int32 Index = 0; Index < Inputs.Num(); Index++)
+		{
+			PreviousIndices.Add(Inputs[Index].Character, Index);
+		}
+		PreviousStates = States;
+
+		States.SetNum(Input.Characters.Num(), false);
+		for (int32 Index = 0; Index < Input.Characters.Num(); Index++)
+		{
+			const FParkourTraversalAsyncCharacterInput& CharacterInput = Input.Characters[Index];
+			if (const int32* PreviousIndex = PreviousIndices.Find(CharacterInput.Character))
+			{
+				States[Index] = PreviousStates[*PreviousIndex];
+			}
+			else
+			{
+				States[Index] = FCharacterState();
+				States[Index].SprintState = CharacterInput.SprintState;
+				States[Index].TimeInSprintState = CharacterInput.TimeInSprintState;
+			}
+		}
+	}
+
+	Inputs = Input.Characters;
+	InputSerial = Input.Serial;
+	MaxSlideCalls = Input.MaxSlideCalls;
+
+	for (int32 Index = 0; Index < Inputs.Num(); Index++)
+	{
+		for (int32 Timer = 0; Timer < static_cast<int32>(EParkourSlideTimer::Num); Timer++)
+		{
+			if (Inputs[Index].bSlideRestarted[Timer])
+			{
+				States[Index].SlideTimeLeft[Timer] = Inputs[Index].SlideInterval[Timer];
+			}
+		}
+	}
+}
+
+void FParkourTraversalAsyncCallback::OnPreSimulate_Internal()
+{
+	// Several steps can run on one snapshot when the frame is longer than the step, and there is no new one for steps in between.
+	if (const FParkourTraversalAsyncInput* Input = GetConsumerInput_Internal())
+	{
+		ConsumeInput(*Input);
+	}
+
+	const float DeltaTime = static_cast<float>(GetDeltaTime_Internal());
+	FParkourTraversalAsyncOutput& Output = GetProducerOutputData_Internal();
+	Output.DeltaTime = DeltaTime;
+	Output.InputSerial = InputSerial;
+	Output.Characters.Reset(Inputs.Num());
+	Output.Results.SetNum(Inputs.Num(), false);
+
+	for (int32 Index = 0; Index < Inputs.Num(); Index++)
+	{
+		const FParkourTraversalAsyncCharacterInput& Input = Inputs[Index];
+		FCharacterState& State = States[Index];
+		FParkourTraversalAsyncResult& Result = Output.Results[Index];
+		Output.Characters.Add(Input.Character);
+
+		// Same countdown as the batched game thread pass.
+		for (int32 Timer = 0; Timer < static_cast<int32>(EParkourSlideTimer::Num); Timer++)
+		{
+			Result.SlideCalls[Timer] = Uparkour_GP4TraversalTickManager::StepSlideTimer(State.SlideTimeLeft[Timer], Input.SlideInterval[Timer], DeltaTime, MaxSlideCalls);
+		}
+
+		Result.bSprintSimulated = Input.bSprintSimulated;
+		Result.bMovingWithInput = Input.bMovingWithInput;
+		if (Input.bSprintSimulated)
+		{
+			State.TimeInSprintState += DeltaTime;
+			const EParkourSprintState NewState = Uparkour_GP4MovementComponent::AdvanceSprintState(State.SprintState, State.TimeInSprintState, Input.Speed2D,
+				Input.bMovingWithInput, Input.bWantsToSprint, Input.bFalling, Input.SprintSustainTime, Input.RunToStopMinSpeed);
+			if (NewState != State.SprintState)
+			{
+				State.SprintState = NewState;
+				State.TimeInSprintState = 0.0f;
+			}
+		}
+		Result.SprintState = State.SprintState;
+	}
+}
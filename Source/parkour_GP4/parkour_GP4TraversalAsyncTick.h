@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "parkour_GP4MovementComponent.h"
+#include "parkour_GP4TraversalTickManager.h"
+
+class Aparkour_GP4Character;
+
+/** What the game thread knows about one character at the end of a frame. */
+struct FParkourTraversalAsyncCharacterInput
+{
+	/** Only compared and copied off the game thread, never resolved. */
+	TWeakObjectPtr<Aparkour_GP4Character> Character;
+
+	// Sprint step inputs, the state and time in state are only used when the character is new to the physics thread.
+	EParkourSprintState SprintState = EParkourSprintState::Stopped;
+	float TimeInSprintState = 0.0f;
+	float Speed2D = 0.0f;
+	float SprintSustainTime = 0.0f;
+	float RunToStopMinSpeed = 0.0f;
+	bool bSprintSimulated = false;
+	bool bMovingWithInput = false;
+	bool bWantsToSprint = false;
+	bool bFalling = false;
+
+	/** Negative while the timer is stopped. */
+	float SlideInterval[static_cast<int32>(EParkourSlideTimer::Num)] = {};
+	/** Set when the timer was started again since the last input, it then counts down from the full interval. */
+	bool bSlideRestarted[static_cast<int32>(EParkourSlideTimer::Num)] = {};
+};
+
+struct FParkourTraversalAsyncInput : public Chaos::FSimCallbackInput
+{
+	uint32 Serial = 0;
+	int32 MaxSlideCalls = 1;
+	TArray<FParkourTraversalAsyncCharacterInput> Characters;
+
+	void Reset() { Characters.Reset(); }
+};
+
+/** Result of one fixed step for one character. */
+struct FParkourTraversalAsyncResult
+{
+	EParkourSprintState SprintState = EParkourSprintState::Stopped;
+	bool bSprintSimulated = false;
+	bool bMovingWithInput = false;
+	/** How often each slide timer expired during the step. */
+	int32 SlideCalls[static_cast<int32>(EParkourSlideTimer::Num)] = {};
+};
+
+/** Everything one fixed step produced, handed back to the game thread in step order. */
+struct FParkourTraversalAsyncOutput : public Chaos::FSimCallbackOutput
+{
+	float DeltaTime = 0.0f;
+	/** Serial of the input the step ran on, so results from before a slide timer restart can be dropped. */
+	uint32 InputSerial = 0;
+	TArray<TWeakObjectPtr<Aparkour_GP4Character>> Characters;
+	TArray<FParkourTraversalAsyncResult> Results;
+
+	void Reset() { Characters.Reset(); Results.Reset(); }
+};
+
+/**
+ * Steps the slide timers and sprint state machines of all parkour characters once per physics step, on the physics thread
+ * when physics ticks async. With a fixed async step the traversal schedule no longer depends on the frame rate.
+ *
+ * The game thread sends a snapshot of the characters at the end of every frame. The physics thread keeps the timer countdowns
+ * and sprint states itself and steps them with whatever snapshot is newest, the results of every step are queued back to the
+ * game thread, which applies them in order while the next steps are already running. No UObjects are touched here.
+ */
+class FParkourTraversalAsyncCallback : public Chaos::TSimCallbackObject<FParkourTraversalAsyncInput, FParkourTraversalAsyncOutput>
+{
+public:
+	virtual void OnPreSimulate_Internal() override;
+
+private:
+	struct FCharacterState
+	{
+		EParkourSprintState SprintState = EParkourSprintState::Stopped;
+		float TimeInSprintState = 0.0f;
+		float SlideTimeLeft[static_cast<int32>(EParkourSlideTimer::Num)] = {};
+	};
+
+	void ConsumeInput(const FParkourTraversalAsyncInput& Input);
+
+	// Physics thread only, Inputs and States share the index.
+	TArray<FParkourTraversalAsyncCharacterInput> Inputs;
+	TArray<FCharacterState> States;
+	TArray<FCharacterState> PreviousStates;
+	TMap<TWeakObjectPtr<Aparkour_GP4Character>, int32> PreviousIndices;
+	uint32 InputSerial = 0;
+	int32 MaxSlideCalls = 1;
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_GAMEPLAY_DEBUGGER
+
+/** Shape that was used for a traversal query. */
+enum class EParkourTraversalQueryShape : uint8
+{
+	Line,
+	Sphere,
+	Capsule,
+	Box
+};
+
+/** One traversal trace as it was issued by the character, kept for the Parkour gameplay debugger category. */
+struct FParkourTraversalQueryRecord
+{
+	FName QueryName;
+	EParkourTraversalQueryShape Shape = EParkourTraversalQueryShape::Line;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+	/** Half size of a box overlap, centered on Start. */
+	FVector Extent = FVector::ZeroVector;
+	bool bHit = false;
+	FVector ImpactPoint = FVector::ZeroVector;
+	double WorldTime = 0.0;
+};
+
+/**
+ * Fixed size ring buffer holding the last traversal queries of a character.
+ * Recording only copies a record into preallocated storage, nothing is drawn until the debugger category asks for it.
+ */
+class FParkourTraversalQueryHistory
+{
+public:
+	static constexpr int32 Capacity = 64;
+
+	void Add(const FParkourTraversalQueryRecord& Record)
+	{
+		Records[NextIndex] = Record;
+		NextIndex = (NextIndex + 1) % Capacity;
+		Num = FMath::Min(Num + 1, Capacity);
+	}
+
+	int32 GetNum() const { return Num; }
+
+	/** Calls Func for every stored record, oldest first. */
+	template <typename FuncType>
+	void ForEach(FuncType Func) const
+	{
+		const int32 FirstIndex = (NextIndex - Num + Capacity) % Capacity;
+		for (int32 i = 0; i < Num; i++)
+		{
+			Func(Records[(FirstIndex + i) % Capacity]);
+		}
+	}
+
+private:
+	TStaticArray<FParkourTraversalQueryRecord, Capacity> Records;
+	int32 NextIndex = 0;
+	int32 Num = 0;
+};
+
+#endif // WITH_GAMEPLAY_DEBUGGER
@@ -0,0 +1,194 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalLinkCommandlet.h"
+#include "parkour_GP4CommandletWorld.h"
+#include "parkour_GP4TraversalNavLink.h"
+#include "parkour_GP4TraversalQueries.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/Parse.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogParkourTraversalLinks, Log, All);
+
+Uparkour_GP4TraversalLinkCommandlet::Uparkour_GP4TraversalLinkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	CharacterHalfHeight = 96.0f;
+	ApproachDistance = 100.0f;
+	SampleSpacing = 100.0f;
+	MinLinkSpacing = 100.0f;
+	MaxObstacleSize = 2000.0f;
+}
+
+int32 Uparkour_GP4TraversalLinkCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName = TEXT("/Game/_Parkour/Maps/ParkourMap");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	UWorld* World = ParkourCommandlet::LoadWorldForTraces(MapName);
+	if (World == nullptr)
+	{
+		UE_LOG(LogParkourTraversalLinks, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	const int32 NumLinks = GenerateLinks(World);
+	UE_LOG(LogParkourTraversalLinks, Display, TEXT("Generated %d traversal links in %s"), NumLinks, *MapName);
+
+	const bool bSaved = ParkourCommandlet::SaveWorld(World);
+	ParkourCommandlet::UnloadWorld(World);
+
+	if (!bSaved)
+	{
+		UE_LOG(LogParkourTraversalLinks, Error, TEXT("Could not save %s"), *MapName);
+		return 1;
+	}
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+int32 Uparkour_GP4TraversalLinkCommandlet::GenerateLinks(UWorld* World)
+{
+	// Remove what the last run generated, hand placed links are kept.
+	for (TActorIterator<Aparkour_GP4TraversalNavLink> It(World); It; ++It)
+	{
+		if (It->ActorHasTag(Aparkour_GP4TraversalNavLink::GeneratedTag))
+		{
+			World->DestroyActor(*It);
+		}
+	}
+
+	FParkourTraversalQueries Queries(World);
+	TArray<FVector> LinkStarts;
+	int32 NumLinks = 0;
+
+	TArray<UStaticMeshComponent*> Obstacles;
+	for (TObjectIterator<UStaticMeshComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && It->GetStaticMesh() && It->GetCollisionResponseToChannel(ECC_Visibility) == ECR_Block)
+		{
+			Obstacles.Add(*It);
+		}
+	}
+
+	for (UStaticMeshComponent* Obstacle : Obstacles)
+	{
+		AnalyzeObstacle(World, Queries, Obstacle, LinkStarts, NumLinks);
+	}
+
+	return NumLinks;
+}
+
+/// <summary>
+/// Walks along all four sides of the obstacle and runs the vault analysis, and the mantle analysis if the vault fails,
+/// from where a character would stand when running straight at that side.
+/// </summary>
+void Uparkour_GP4TraversalLinkCommandlet::AnalyzeObstacle(UWorld* World, FParkourTraversalQueries& Queries, UStaticMeshComponent* Obstacle, TArray<FVector>& LinkStarts, int32& NumLinks)
+{
+	const FTransform& Transform = Obstacle->GetComponentTransform();
+	const FBox LocalBox = Obstacle->GetStaticMesh()->GetBoundingBox();
+	const FVector Center = Transform.TransformPosition(LocalBox.GetCenter());
+	const FVector Extent = LocalBox.GetExtent() * Transform.GetScale3D().GetAbs();
+
+	if (FMath::Max(Extent.X, Extent.Y) * 2.0f > MaxObstacleSize)
+	{
+		return;
+	}
+
+	const FVector AxisX = Transform.GetUnitAxis(EAxis::X).GetSafeNormal2D();
+	const FVector AxisY = Transform.GetUnitAxis(EAxis::Y).GetSafeNormal2D();
+	if (AxisX.IsNearlyZero() || AxisY.IsNearlyZero())
+	{
+		return;
+	}
+
+	struct FSide
+	{
+		FVector Normal;
+		FVector Tangent;
+		float Depth;
+		float HalfWidth;
+	};
+	const FSide Sides[] =
+	{
+		{ AxisX, AxisY, Extent.X, Extent.Y },
+		{ -AxisX, AxisY, Extent.X, Extent.Y },
+		{ AxisY, AxisX, Extent.Y, Extent.X },
+		{ -AxisY, AxisX, Extent.Y, Extent.X },
+	};
+
+	const FParkourIgnoreActors NoActorsToIgnore;
+
+	for (const FSide& Side : Sides)
+	{
+		const int32 NumSamples = FMath::Max(1, FMath::FloorToInt(Side.HalfWidth * 2.0f / SampleSpacing));
+		for (int32 SampleIndex = 0; SampleIndex < NumSamples; SampleIndex++)
+		{
+			const float Offset = (SampleIndex + 0.5f) / NumSamples * Side.HalfWidth * 2.0f - Side.HalfWidth;
+			const FVector Approach = Center + Side.Normal * (Side.Depth + ApproachDistance) + Side.Tangent * Offset;
+
+			// Find the floor the character would be standing on.
+			FHitResult FloorHit;
+			const FVector FloorTraceStart(Approach.X, Approach.Y, Center.Z + Extent.Z + CharacterHalfHeight);
+			const FVector FloorTraceEnd(Approach.X, Approach.Y, Center.Z - Extent.Z - 500.0f);
+			if (!Queries.LineTrace(TEXT("TraversalLink.Floor"), FloorTraceStart, FloorTraceEnd, NoActorsToIgnore, FloorHit) || FloorHit.GetComponent() == Obstacle)
+			{
+				continue;
+			}
+
+			const FVector LinkStart = FloorHit.ImpactPoint;
+			if (LinkStarts.ContainsByPredicate([&](const FVector& Existing) { return FVector::DistSquared(Existing, LinkStart) < FMath::Square(MinLinkSpacing); }))
+			{
+				continue;
+			}
+
+			const FVector Origin = LinkStart + FVector(0.0f, 0.0f, CharacterHalfHeight);
+			const FVector Forward = -Side.Normal;
+
+			Aparkour_GP4TraversalNavLink* Link = nullptr;
+
+			FParkourVaultResult VaultResult;
+			ParkourTraversal::AnalyzeVault(Queries, VaultParams, Origin, Forward, VaultResult);
+			if (VaultResult.CanVault && !VaultResult.VaultLandLocation.IsZero())
+			{
+				Link = World->SpawnActor<Aparkour_GP4TraversalNavLink>(LinkStart, Forward.Rotation());
+				if (Link)
+				{
+					Link->SetTraversal(EParkourTraversalType::Vault, LinkStart, VaultResult.VaultLandLocation,
+						VaultResult.VaultStartLocation, VaultResult.VaultMiddleLocation, VaultResult.VaultLandLocation, VaultResult.VaultDistance);
+				}
+			}
+			else
+			{
+				FParkourMantleResult MantleResult;
+				ParkourTraversal::AnalyzeMantle(Queries, MantleParams, Origin, Forward, false, MantleResult);
+				if (MantleResult.CanMantle)
+				{
+					Link = World->SpawnActor<Aparkour_GP4TraversalNavLink>(LinkStart, Forward.Rotation());
+					if (Link)
+					{
+						Link->SetTraversal(EParkourTraversalType::Mantle, LinkStart, MantleResult.MantlePosition2,
+							MantleResult.MantlePosition1, FVector::ZeroVector, MantleResult.MantlePosition2, 0);
+					}
+				}
+			}
+
+			if (Link)
+			{
+				Link->Tags.Add(Aparkour_GP4TraversalNavLink::GeneratedTag);
+				LinkStarts.Add(LinkStart);
+				NumLinks++;
+			}
+		}
+	}
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalLinkCommandlet.generated.h"
+
+class UStaticMeshComponent;
+class FParkourTraversalQueries;
+
+/**
+ * Runs the vault and mantle analysis offline around every obstacle in a map and saves the results as traversal nav links.
+ *
+ * UnrealEditor-Cmd parkour_GP4.uproject -run=parkour_GP4TraversalLink -Map=/Game/_Parkour/Maps/ParkourMap
+ *
+ * Links from a previous run are replaced. Rebuild the navigation data afterwards so the links are part of the navmesh.
+ */
+UCLASS(config=Game)
+class Uparkour_GP4TraversalLinkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	Uparkour_GP4TraversalLinkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	int32 GenerateLinks(UWorld* World);
+	void AnalyzeObstacle(UWorld* World, FParkourTraversalQueries& Queries, UStaticMeshComponent* Obstacle, TArray<FVector>& LinkStarts, int32& NumLinks);
+
+	/** Should match what the character Blueprint passes to VaultTrace. */
+	UPROPERTY(config)
+		FParkourVaultParams VaultParams;
+
+	/** Should match what the character Blueprint passes to MantleTrace. */
+	UPROPERTY(config)
+		FParkourMantleParams MantleParams;
+
+	/** Height of the character origin above the floor, the capsule half height. */
+	UPROPERTY(config)
+		float CharacterHalfHeight;
+
+	/** How far in front of an obstacle face the analysis starts. */
+	UPROPERTY(config)
+		float ApproachDistance;
+
+	/** Distance between samples along an obstacle face. */
+	UPROPERTY(config)
+		float SampleSpacing;
+
+	/** Links starting closer than this to an existing link are skipped. */
+	UPROPERTY(config)
+		float MinLinkSpacing;
+
+	/** Components bigger than this horizontally are floors or walls, not obstacles. */
+	UPROPERTY(config)
+		float MaxObstacleSize;
+};
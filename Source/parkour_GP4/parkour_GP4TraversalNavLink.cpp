@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalNavLink.h"
+#include "parkour_GP4Character.h"
+#include "NavLinkCustomComponent.h"
+
+const FName Aparkour_GP4TraversalNavLink::GeneratedTag(TEXT("ParkourGeneratedLink"));
+
+Aparkour_GP4TraversalNavLink::Aparkour_GP4TraversalNavLink()
+{
+	// Only the smart link is used, the default simple link would let the pathfinder walk through the obstacle.
+	PointLinks.Empty();
+	bSmartLinkIsRelevant = true;
+
+	TraversalType = EParkourTraversalType::Vault;
+	StartLocation = FVector::ZeroVector;
+	MiddleLocation = FVector::ZeroVector;
+	LandLocation = FVector::ZeroVector;
+	VaultDistance = 0;
+}
+
+void Aparkour_GP4TraversalNavLink::SetTraversal(EParkourTraversalType InTraversalType, const FVector& LinkStart, const FVector& LinkEnd, const FVector& InStartLocation, const FVector& InMiddleLocation, const FVector& InLandLocation, int32 InVaultDistance)
+{
+	TraversalType = InTraversalType;
+	StartLocation = InStartLocation;
+	MiddleLocation = InMiddleLocation;
+	LandLocation = InLandLocation;
+	VaultDistance = InVaultDistance;
+
+	SetActorLocation(LinkStart);
+	GetSmartLinkComp()->SetLinkData(FVector::ZeroVector, GetActorTransform().InverseTransformPosition(LinkEnd), ENavLinkDirection::LeftToRight);
+	GetSmartLinkComp()->SetEnabled(true);
+}
+
+void Aparkour_GP4TraversalNavLink::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OnSmartLinkReached.AddDynamic(this, &Aparkour_GP4TraversalNavLink::HandleSmartLinkReached);
+}
+
+void Aparkour_GP4TraversalNavLink::HandleSmartLinkReached(AActor* MovingActor, const FVector& DestinationPoint)
+{
+	if (Aparkour_GP4Character* Character = Cast<Aparkour_GP4Character>(MovingActor))
+	{
+		Character->StartNavLinkTraversal(this);
+	}
+	else
+	{
+		// Not a parkour character, let it carry on without the traversal.
+		ResumePathFollowing(MovingActor);
+	}
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Navigation/NavLinkProxy.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalNavLink.generated.h"
+
+/**
+ * Smart nav link over a vaultable or mantleable obstacle, generated offline by the parkour_GP4TraversalLink commandlet.
+ * Keeps the traversal points found by the analysis so AI characters can vault or mantle without tracing at runtime.
+ */
+UCLASS()
+class Aparkour_GP4TraversalNavLink : public ANavLinkProxy
+{
+	GENERATED_BODY()
+
+public:
+	Aparkour_GP4TraversalNavLink();
+
+	/** Places the link between LinkStart and LinkEnd on the navmesh and stores the traversal points. */
+	void SetTraversal(EParkourTraversalType InTraversalType, const FVector& LinkStart, const FVector& LinkEnd, const FVector& InStartLocation, const FVector& InMiddleLocation, const FVector& InLandLocation, int32 InVaultDistance);
+
+	virtual void BeginPlay() override;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Traversal)
+		EParkourTraversalType TraversalType;
+
+	/** Vault start location or first mantle position */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Traversal)
+		FVector StartLocation;
+
+	/** Vault middle location, unused for mantles */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Traversal)
+		FVector MiddleLocation;
+
+	/** Vault land location or second mantle position */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Traversal)
+		FVector LandLocation;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Traversal)
+		int VaultDistance;
+
+	/** Tag of the links the commandlet owns, they are removed and generated again on every run. */
+	static const FName GeneratedTag;
+
+protected:
+	UFUNCTION()
+		void HandleSmartLinkReached(AActor* MovingActor, const FVector& DestinationPoint);
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalPrefilter.h"
+#include "parkour_GP4TraversalQueries.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarTraversalPrefilter(
+	TEXT("parkour.TraversalPrefilter"),
+	true,
+	TEXT("Skip the vault and mantle trace chains when nothing that blocks them is within reach of the character."));
+
+static TAutoConsoleVariable<bool> CVarTraversalPrefilterVerify(
+	TEXT("parkour.TraversalPrefilter.Verify"),
+	false,
+	TEXT("Run the first trace of a skipped chain anyway and log a warning when it hits something."));
+
+static TAutoConsoleVariable<float> CVarTraversalPrefilterMargin(
+	TEXT("parkour.TraversalPrefilter.Margin"),
+	100.0f,
+	TEXT("Distance in cm the overlap box reaches past the traversal reach. The character can move this far before it is queried again."));
+
+static TAutoConsoleVariable<float> CVarTraversalPrefilterHeightMargin(
+	TEXT("parkour.TraversalPrefilter.HeightMargin"),
+	30.0f,
+	TEXT("Distance in cm the overlap box reaches above and below the height of the first trace. Has to stay below the capsule half height,\n")
+	TEXT("otherwise the floor the character stands on is always in the box and no chain is ever skipped."));
+
+static TAutoConsoleVariable<float> CVarTraversalPrefilterMaxAge(
+	TEXT("parkour.TraversalPrefilter.MaxAge"),
+	0.5f,
+	TEXT("Seconds after which the nearby primitives are always gathered again, so moved or spawned obstacles are picked up."));
+
+uint64 FParkourTraversalPrefilter::TotalChainsSkipped = 0;
+uint64 FParkourTraversalPrefilter::TotalChainsRun = 0;
+uint64 FParkourTraversalPrefilter::TotalOverlapQueries = 0;
+
+bool FParkourTraversalPrefilter::HasTraversablesInReach(FParkourTraversalQueries& Queries, const FVector& Origin, const FVector& Forward, float Reach)
+{
+	const UWorld* World = Queries.GetWorld();
+	if (!CVarTraversalPrefilter.GetValueOnGameThread() || World == nullptr)
+	{
+		return true;
+	}
+
+	// The reach of the chain has to stay inside the box that was queried, the trace only moves along the character's height.
+	const double Now = World->GetTimeSeconds();
+	const FVector Offset = (Origin - QueryCenter).GetAbs();
+	const bool bCovered = bValid
+		&& Offset.X + Reach <= QueryExtent.X
+		&& Offset.Y + Reach <= QueryExtent.Y
+		&& Offset.Z <= QueryExtent.Z
+		&& Now - QueryTime <= CVarTraversalPrefilterMaxAge.GetValueOnGameThread();
+
+	const bool bAnyAlive = NearbyPrimitives.ContainsByPredicate([](const TWeakObjectPtr<UPrimitiveComponent>& Primitive) { return Primitive.IsValid(); });
+	if (!bCovered || (NearbyPrimitives.Num() > 0 && !bAnyAlive))
+	{
+		GatherNearbyPrimitives(Queries, Origin, Reach, Now);
+	}
+
+	if (NearbyPrimitives.Num() > 0)
+	{
+		TotalChainsRun++;
+		return true;
+	}
+
+	TotalChainsSkipped++;
+
+	if (CVarTraversalPrefilterVerify.GetValueOnGameThread())
+	{
+		FHitResult Hit;
+		if (Queries.LineTrace(TEXT("TraversalPrefilter.Verify"), Origin, Origin + Forward * Reach, FParkourIgnoreActors(), Hit))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Traversal prefilter skipped a chain whose first trace hits '%s'"), *GetNameSafe(Hit.GetComponent()));
+		}
+	}
+	return false;
+}
+
+void FParkourTraversalPrefilter::GatherNearbyPrimitives(FParkourTraversalQueries& Queries, const FVector& Origin, float Reach, double Now)
+{
+	const float Margin = FMath::Max(CVarTraversalPrefilterMargin.GetValueOnGameThread(), 0.0f);
+	const float HeightMargin = FMath::Max(CVarTraversalPrefilterHeightMargin.GetValueOnGameThread(), 0.0f);
+
+	// The first trace of both chains is level with Origin, so only a thin band around that height matters.
+	QueryCenter = Origin;
+	QueryExtent = FVector(Reach + Margin, Reach + Margin, HeightMargin);
+	QueryTime = Now;
+	bValid = true;
+	TotalOverlapQueries++;
+
+	NearbyPrimitives.Reset();
+	Queries.BoxOverlapBlocking(TEXT("TraversalPrefilter"), QueryCenter, QueryExtent, Overlaps);
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		NearbyPrimitives.AddUnique(Overlap.Component);
+	}
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/OverlapResult.h"
+
+class FParkourTraversalQueries;
+class UPrimitiveComponent;
+
+/**
+ * Broadphase check in front of the vault and mantle trace chains.
+ * Both chains start with a line trace of InitialTraceLength from the character and stop when it misses,
+ * so when nothing that blocks the traversal traces is within that reach the whole chain can be skipped.
+ *
+ * The nearby primitives are gathered with one box overlap around the character that is larger than the reach by
+ * parkour.TraversalPrefilter.Margin, and only gathered again once the character leaves the covered area or they are too old.
+ * The box is only parkour.TraversalPrefilter.HeightMargin high above and below the trace, so the floor underfoot is not in it.
+ */
+class FParkourTraversalPrefilter
+{
+public:
+	/**
+	 * Returns false if a line trace of Reach along Forward from Origin cannot hit anything, gathering the nearby primitives first if needed.
+	 * Always true while parkour.TraversalPrefilter is off.
+	 */
+	bool HasTraversablesInReach(FParkourTraversalQueries& Queries, const FVector& Origin, const FVector& Forward, float Reach);
+
+	/** Forgets the nearby primitives so the next check gathers them again. */
+	void Invalidate() { bValid = false; }
+
+	/** Chains skipped and overlap queries made by all characters so far, read by the soak test stats. */
+	static uint64 GetTotalChainsSkipped() { return TotalChainsSkipped; }
+	static uint64 GetTotalChainsRun() { return TotalChainsRun; }
+	static uint64 GetTotalOverlapQueries() { return TotalOverlapQueries; }
+
+private:
+	void GatherNearbyPrimitives(FParkourTraversalQueries& Queries, const FVector& Origin, float Reach, double Now);
+
+	TArray<TWeakObjectPtr<UPrimitiveComponent>, TInlineAllocator<16>> NearbyPrimitives;
+	TArray<FOverlapResult> Overlaps;
+	FVector QueryCenter = FVector::ZeroVector;
+	FVector QueryExtent = FVector::ZeroVector;
+	double QueryTime = 0.0;
+	bool bValid = false;
+
+	static uint64 TotalChainsSkipped;
+	static uint64 TotalChainsRun;
+	static uint64 TotalOverlapQueries;
+};
@@ -0,0 +1,181 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalQueries.h"
+#include "parkour_GP4Scalability.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+FParkourTraversalQueries::FParkourTraversalQueries()
+	: QueryParams(SCENE_QUERY_STAT(ParkourTraversal), false)
+{
+	// Blueprints read the vault and mantle hits, so they carry the physical material like Kismet traces do.
+	QueryParams.bReturnPhysicalMaterial = true;
+}
+
+FParkourTraversalQueries::FParkourTraversalQueries(const UObject* InWorldContextObject)
+	: FParkourTraversalQueries()
+{
+	WorldContextObject = InWorldContextObject;
+	bIgnoreSelf = InWorldContextObject && InWorldContextObject->IsA<AActor>();
+	if (bIgnoreSelf)
+	{
+		QueryParams.AddIgnoredActor(CastChecked<AActor>(InWorldContextObject));
+	}
+}
+
+UWorld* FParkourTraversalQueries::GetWorld() const
+{
+	return WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+}
+
+const FCollisionQueryParams& FParkourTraversalQueries::GetQueryParams(FName QueryName, TConstArrayView<AActor*> ActorsToIgnore)
+{
+	if (bHasQueryIgnoredActors)
+	{
+		QueryParams.ClearIgnoredActors();
+		if (bIgnoreSelf)
+		{
+			QueryParams.AddIgnoredActor(CastChecked<AActor>(WorldContextObject));
+		}
+		bHasQueryIgnoredActors = false;
+	}
+
+	for (const AActor* Actor : ActorsToIgnore)
+	{
+		if (Actor)
+		{
+			QueryParams.AddIgnoredActor(Actor);
+			bHasQueryIgnoredActors = true;
+		}
+	}
+
+	QueryParams.TraceTag = QueryName;
+	return QueryParams;
+}
+
+bool FParkourTraversalQueries::LineTrace(FName QueryName, const FVector& Start, const FVector& End, TConstArrayView<AActor*> ActorsToIgnore, FHitResult& OutHit)
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	NumQueries++;
+	bool bHit = World->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, GetQueryParams(QueryName, ActorsToIgnore));
+
+#if WITH_GAMEPLAY_DEBUGGER
+	Record(QueryName, EParkourTraversalQueryShape::Line, Start, End, 0.0f, 0.0f, bHit, OutHit);
+#endif
+	return bHit;
+}
+
+bool FParkourTraversalQueries::SphereTrace(FName QueryName, const FVector& Start, const FVector& End, float Radius, TConstArrayView<AActor*> ActorsToIgnore, FHitResult& OutHit, bool bAlwaysSweep)
+{
+	// Lowest shape complexity trades the sweep for a ray along the same path, or down through the sphere for an overlap check.
+	if (ParkourScalability::GetShapeComplexity() < 1 && !bAlwaysSweep)
+	{
+		if (Start.Equals(End))
+		{
+			const FVector Axis(0.0f, 0.0f, Radius);
+			return LineTrace(QueryName, Start + Axis, Start - Axis, ActorsToIgnore, OutHit);
+		}
+		return LineTrace(QueryName, Start, End, ActorsToIgnore, OutHit);
+	}
+
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	NumQueries++;
+	bool bHit = World->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(Radius), GetQueryParams(QueryName, ActorsToIgnore));
+
+#if WITH_GAMEPLAY_DEBUGGER
+	Record(QueryName, EParkourTraversalQueryShape::Sphere, Start, End, Radius, 0.0f, bHit, OutHit);
+#endif
+	return bHit;
+}
+
+bool FParkourTraversalQueries::CapsuleTrace(FName QueryName, const FVector& Start, const FVector& End, float Radius, float HalfHeight, TConstArrayView<AActor*> ActorsToIgnore, FHitResult& OutHit)
+{
+	// Below full shape complexity the capsule becomes a ray down its axis, which still finds floors and ceilings.
+	if (ParkourScalability::GetShapeComplexity() < 2 && Start.Equals(End))
+	{
+		const FVector Axis(0.0f, 0.0f, HalfHeight);
+		return LineTrace(QueryName, Start + Axis, Start - Axis, ActorsToIgnore, OutHit);
+	}
+
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	NumQueries++;
+	bool bHit = World->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeCapsule(Radius, HalfHeight), GetQueryParams(QueryName, ActorsToIgnore));
+
+#if WITH_GAMEPLAY_DEBUGGER
+	Record(QueryName, EParkourTraversalQueryShape::Capsule, Start, End, Radius, HalfHeight, bHit, OutHit);
+#endif
+	return bHit;
+}
+
+bool FParkourTraversalQueries::BoxOverlapBlocking(FName QueryName, const FVector& Center, const FVector& HalfExtent, TArray<FOverlapResult>& OutOverlaps)
+{
+	OutOverlaps.Reset();
+
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return false;
+	}
+
+	// Same channel and simple collision as the traces, so anything a trace could hit inside the box is found.
+	NumQueries++;
+	World->OverlapMultiByChannel(OutOverlaps, Center, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeBox(HalfExtent), GetQueryParams(QueryName, FParkourIgnoreActors()));
+
+	OutOverlaps.RemoveAllSwap([](const FOverlapResult& Overlap) { return !Overlap.bBlockingHit; }, false);
+	const bool bHit = OutOverlaps.Num() > 0;
+
+#if WITH_GAMEPLAY_DEBUGGER
+	Record(QueryName, EParkourTraversalQueryShape::Box, Center, Center, 0.0f, 0.0f, bHit, FHitResult(), HalfExtent);
+#endif
+	return bHit;
+}
+
+#if WITH_GAMEPLAY_DEBUGGER
+void FParkourTraversalQueries::RecordFor(float Seconds)
+{
+	if (const UWorld* World = GetWorld())
+	{
+		RecordEndTime = World->GetTimeSeconds() + Seconds;
+	}
+}
+
+void FParkourTraversalQueries::Record(FName QueryName, EParkourTraversalQueryShape Shape, const FVector& Start, const FVector& End, float Radius, float HalfHeight, bool bHit, const FHitResult& Hit, const FVector& Extent)
+{
+	// Only the character selected in the gameplay debugger keeps RecordEndTime ahead of the world time.
+	const UWorld* World = GetWorld();
+	if (World == nullptr || World->GetTimeSeconds() > RecordEndTime || !ParkourScalability::IsDebugRecordingEnabled())
+	{
+		return;
+	}
+
+	FParkourTraversalQueryRecord QueryRecord;
+	QueryRecord.QueryName = QueryName;
+	QueryRecord.Shape = Shape;
+	QueryRecord.Start = Start;
+	QueryRecord.End = End;
+	QueryRecord.Radius = Radius;
+	QueryRecord.HalfHeight = HalfHeight;
+	QueryRecord.Extent = Extent;
+	QueryRecord.bHit = bHit;
+	QueryRecord.ImpactPoint = Hit.ImpactPoint;
+	QueryRecord.WorldTime = World->GetTimeSeconds();
+
+	History.Add(QueryRecord);
+}
+#endif
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "parkour_GP4TraversalDebug.h"
+
+struct FOverlapResult;
+
+/** Actors a single traversal query ignores besides the character. Kept inline so building the list never allocates. */
+using FParkourIgnoreActors = TArray<AActor*, TInlineAllocator<4>>;
+
+/**
+ * Issues the traversal traces for a character, or for offline tools when there is no character.
+ * All vault, mantle and slide traces go through here so they can be recorded for the Parkour gameplay debugger category.
+ *
+ * The queries go straight to the world with collision params built once per character, so a query does not allocate
+ * once the character is set up. The Parkour.Traversal.QueryAllocations automation test checks that.
+ */
+class FParkourTraversalQueries
+{
+public:
+	FParkourTraversalQueries();
+
+	/** If the world context is an actor, that actor is ignored by every query. */
+	explicit FParkourTraversalQueries(const UObject* InWorldContextObject);
+
+	bool LineTrace(FName QueryName, const FVector& Start, const FVector& End, TConstArrayView<AActor*> ActorsToIgnore, FHitResult& OutHit);
+
+	/**
+	 * Below shape complexity 1 the sweep becomes a ray, unless bAlwaysSweep is set.
+	 * Probes that come down onto the front face of an obstacle set it, a ray there runs along the face and can miss the top.
+	 */
+	bool SphereTrace(FName QueryName, const FVector& Start, const FVector& End, float Radius, TConstArrayView<AActor*> ActorsToIgnore, FHitResult& OutHit, bool bAlwaysSweep = false);
+
+	bool CapsuleTrace(FName QueryName, const FVector& Start, const FVector& End, float Radius, float HalfHeight, TConstArrayView<AActor*> ActorsToIgnore, FHitResult& OutHit);
+
+	/** Finds everything in the box that blocks the traversal traces. Returns true if there is anything. */
+	bool BoxOverlapBlocking(FName QueryName, const FVector& Center, const FVector& HalfExtent, TArray<FOverlapResult>& OutOverlaps);
+
+	UWorld* GetWorld() const;
+
+	/** Number of traces issued through this object so far. */
+	uint32 GetNumQueries() const { return NumQueries; }
+
+#if WITH_GAMEPLAY_DEBUGGER
+	/** Returns the last traversal queries **/
+	const FParkourTraversalQueryHistory& GetHistory() const { return History; }
+
+	/** Records the queries of the next Seconds of world time. Nothing is recorded unless this keeps being called. */
+	void RecordFor(float Seconds);
+#endif
+
+private:
+	/** Points the reused params at this query and adds its ignored actors. */
+	const FCollisionQueryParams& GetQueryParams(FName QueryName, TConstArrayView<AActor*> ActorsToIgnore);
+
+#if WITH_GAMEPLAY_DEBUGGER
+	void Record(FName QueryName, EParkourTraversalQueryShape Shape, const FVector& Start, const FVector& End, float Radius, float HalfHeight, bool bHit, const FHitResult& Hit, const FVector& Extent = FVector::ZeroVector);
+
+	FParkourTraversalQueryHistory History;
+
+	/** World time until which queries are recorded. */
+	double RecordEndTime = -1.0;
+#endif
+
+	const UObject* WorldContextObject = nullptr;
+	bool bIgnoreSelf = false;
+	uint32 NumQueries = 0;
+
+	/** Simple collision, ignoring the character. Query specific ignored actors are added on top and removed by the next query. */
+	FCollisionQueryParams QueryParams;
+	bool bHasQueryIgnoredActors = false;
+};
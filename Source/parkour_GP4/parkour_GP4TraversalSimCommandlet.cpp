@@ -0,0 +1,571 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalSimCommandlet.h"
+#include "parkour_GP4CommandletWorld.h"
+#include "parkour_GP4Scalability.h"
+#include "parkour_GP4StressCourse.h"
+#include "parkour_GP4TraversalQueries.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogParkourTraversalSim, Log, All);
+
+Uparkour_GP4TraversalSimCommandlet::Uparkour_GP4TraversalSimCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	CharacterHalfHeight = 96.0f;
+	SampleSpacing = 50.0f;
+	MaxObstacleSize = 2000.0f;
+	ApproachAngles = { -60.0f, -45.0f, -30.0f, -15.0f, 0.0f, 15.0f, 30.0f, 45.0f, 60.0f };
+	ApproachDistances = { 40.0f, 80.0f, 120.0f, 160.0f };
+	ApproachSpeeds = { 300.0f, 500.0f, 800.0f };
+	JumpHeights = { 40.0f, 80.0f, 120.0f };
+	SyntheticDepths = { 20.0f, 40.0f, 60.0f, 90.0f, 120.0f, 160.0f, 200.0f, 250.0f, 300.0f, 400.0f };
+	SyntheticHeights = { 30.0f, 60.0f, 90.0f, 120.0f, 150.0f, 180.0f, 210.0f, 250.0f };
+	CoverageCellSize = 25.0f;
+}
+
+int32 Uparkour_GP4TraversalSimCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName = TEXT("/Game/_Parkour/Maps/ParkourMap");
+	FParse::Value(*Params, TEXT("Map="), MapName);
+
+	UWorld* World = ParkourCommandlet::LoadWorldForTraces(MapName);
+	if (World == nullptr)
+	{
+		UE_LOG(LogParkourTraversalSim, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	TArray<FObstacle> Obstacles;
+	int32 StressCourseSeed = 0;
+	if (FParse::Value(*Params, TEXT("StressCourse="), StressCourseSeed))
+	{
+		// Far above the map and the synthetic boxes so neither gets in the way of the other.
+		const FTransform CourseTransform(FVector(0.0f, 0.0f, 200000.0f));
+		Aparkour_GP4StressCourse* StressCourse = World->SpawnActorDeferred<Aparkour_GP4StressCourse>(Aparkour_GP4StressCourse::StaticClass(), CourseTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		StressCourse->Seed = StressCourseSeed;
+		StressCourse->FinishSpawning(CourseTransform);
+		GatherObstacles(World, Obstacles, StressCourse);
+
+		UE_LOG(LogParkourTraversalSim, Display, TEXT("Stress course seed %d, layout hash %08x"), StressCourseSeed, StressCourse->GetLayoutHash());
+	}
+	else
+	{
+		GatherObstacles(World, Obstacles);
+	}
+
+	if (FParse::Param(*Params, TEXT("Synthetic")))
+	{
+		SpawnSyntheticObstacles(World, Obstacles);
+	}
+
+	// Nothing ticks the world, spawned obstacles only become visible to queries once the scene is flushed.
+	if (FPhysScene* PhysScene = World->GetPhysicsScene())
+	{
+		PhysScene->Flush();
+	}
+
+	FParkourTraversalQueries SetupQueries(World);
+	TArray<FApproach> Approaches;
+	BuildApproaches(SetupQueries, Obstacles, Approaches);
+
+	// Console variables are read here, the workers only get plain values.
+	FParkourVaultParams SimVaultParams = VaultParams;
+	SimVaultParams.MaxDepthSteps = ParkourScalability::GetVaultDepthSteps();
+	SimVaultParams.bBisectDepth = !FParse::Param(*Params, TEXT("Linear"));
+
+	// Every worker gets its own run of approaches and its own queries, the results go into separate slots so nothing is shared.
+	const bool bSingleThread = FParse::Param(*Params, TEXT("SingleThread"));
+	const int32 NumWorkers = bSingleThread ? 1 : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumChunks = FMath::Min(NumWorkers * 4, FMath::Max(Approaches.Num(), 1));
+	const int32 ChunkSize = FMath::DivideAndRoundUp(Approaches.Num(), NumChunks);
+
+	UE_LOG(LogParkourTraversalSim, Display, TEXT("Simulating %d approaches around %d obstacles on %d threads"), Approaches.Num(), Obstacles.Num(), NumWorkers);
+
+	TArray<FDecision> Decisions;
+	Decisions.SetNum(Approaches.Num());
+
+	const double StartTime = FPlatformTime::Seconds();
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		FParkourTraversalQueries Queries(World);
+		const int32 First = Chunk * ChunkSize;
+		const int32 Last = FMath::Min(First + ChunkSize, Approaches.Num());
+		for (int32 Index = First; Index < Last; Index++)
+		{
+			Decisions[Index] = Simulate(Queries, SimVaultParams, Approaches[Index]);
+		}
+	}, bSingleThread ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced);
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	const FString OutputDir = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("TraversalSim");
+	WriteDecisions(OutputDir, Obstacles, Approaches, Decisions);
+	WriteCoverageMap(OutputDir, Obstacles, Approaches, Decisions);
+	WriteSizeCoverage(OutputDir, Obstacles, Approaches, Decisions);
+	LogSummary(Obstacles, Approaches, Decisions, Seconds);
+
+	ParkourCommandlet::UnloadWorld(World);
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+void Uparkour_GP4TraversalSimCommandlet::GatherObstacles(UWorld* World, TArray<FObstacle>& Obstacles, const AActor* OnlyOwner) const
+{
+	// Same components the traversal link generation treats as obstacles.
+	for (TObjectIterator<UStaticMeshComponent> It; It; ++It)
+	{
+		if (It->GetWorld() != World || !It->GetStaticMesh() || It->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+		{
+			continue;
+		}
+		if (OnlyOwner && It->GetOwner() != OnlyOwner)
+		{
+			continue;
+		}
+
+		const FString Name = It->GetOwner() ? It->GetOwner()->GetName() : It->GetName();
+		if (const UInstancedStaticMeshComponent* Instances = Cast<UInstancedStaticMeshComponent>(*It))
+		{
+			for (int32 InstanceIndex = 0; InstanceIndex < Instances->GetInstanceCount(); InstanceIndex++)
+			{
+				FObstacle& Obstacle = Obstacles.AddDefaulted_GetRef();
+				Obstacle.Component = *It;
+				Obstacle.InstanceIndex = InstanceIndex;
+				Obstacle.Name = FString::Printf(TEXT("%s_%s_%d"), *Name, *It->GetName(), InstanceIndex);
+			}
+			continue;
+		}
+
+		FObstacle& Obstacle = Obstacles.AddDefaulted_GetRef();
+		Obstacle.Component = *It;
+		Obstacle.Name = Name;
+	}
+}
+
+FTransform Uparkour_GP4TraversalSimCommandlet::GetObstacleTransform(const FObstacle& Obstacle)
+{
+	FTransform Transform = Obstacle.Component->GetComponentTransform();
+	if (Obstacle.InstanceIndex != INDEX_NONE)
+	{
+		CastChecked<UInstancedStaticMeshComponent>(Obstacle.Component)->GetInstanceTransform(Obstacle.InstanceIndex, Transform, true);
+	}
+	return Transform;
+}
+
+/// <summary>
+/// Places one box per depth and height on a floor of its own, high above the map so the map does not get in the way.
+/// The boxes are far enough apart that the approaches of one never reach the next.
+/// </summary>
+void Uparkour_GP4TraversalSimCommandlet::SpawnSyntheticObstacles(UWorld* World, TArray<FObstacle>& Obstacles) const
+{
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (CubeMesh == nullptr)
+	{
+		UE_LOG(LogParkourTraversalSim, Warning, TEXT("Could not load the engine cube, no synthetic obstacles"));
+		return;
+	}
+
+	// The basic cube is 100cm on every side with its pivot in the middle.
+	const FVector Ground(0.0f, 0.0f, 100000.0f);
+	const float Spacing = 1500.0f;
+	const float ObstacleWidth = 200.0f;
+
+	auto SpawnBox = [&](const FVector& Center, const FVector& Size)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Center, FRotator::ZeroRotator, SpawnParams);
+		Box->SetMobility(EComponentMobility::Movable);
+		Box->GetStaticMeshComponent()->SetStaticMesh(CubeMesh);
+		Box->SetActorScale3D(Size / 100.0f);
+		return Box;
+	};
+
+	const FVector FloorSize(SyntheticDepths.Num() * Spacing, SyntheticHeights.Num() * Spacing, 100.0f);
+	SpawnBox(Ground + FVector(FloorSize.X * 0.5f, FloorSize.Y * 0.5f, -50.0f), FloorSize);
+
+	for (int32 DepthIndex = 0; DepthIndex < SyntheticDepths.Num(); DepthIndex++)
+	{
+		for (int32 HeightIndex = 0; HeightIndex < SyntheticHeights.Num(); HeightIndex++)
+		{
+			const float Depth = SyntheticDepths[DepthIndex];
+			const float Height = SyntheticHeights[HeightIndex];
+			const FVector Center = Ground + FVector((DepthIndex + 0.5f) * Spacing, (HeightIndex + 0.5f) * Spacing, Height * 0.5f);
+			AStaticMeshActor* Box = SpawnBox(Center, FVector(Depth, ObstacleWidth, Height));
+
+			FObstacle& Obstacle = Obstacles.AddDefaulted_GetRef();
+			Obstacle.Component = Box->GetStaticMeshComponent();
+			Obstacle.Name = FString::Printf(TEXT("Synthetic_%.0fx%.0f"), Depth, Height);
+			Obstacle.SyntheticSize = FVector2D(Depth, Height);
+		}
+	}
+}
+
+/// <summary>
+/// Walks along all four sides of every obstacle and sets up an approach for every angle, distance and speed at each point.
+/// The character stands on the floor found below the approach point, approaches in the air start higher and always fall.
+/// </summary>
+void Uparkour_GP4TraversalSimCommandlet::BuildApproaches(FParkourTraversalQueries& Queries, const TArray<FObstacle>& Obstacles, TArray<FApproach>& Approaches) const
+{
+	const FParkourIgnoreActors NoActorsToIgnore;
+
+	for (int32 ObstacleIndex = 0; ObstacleIndex < Obstacles.Num(); ObstacleIndex++)
+	{
+		const FObstacle& Obstacle = Obstacles[ObstacleIndex];
+		const UStaticMeshComponent* Component = Obstacle.Component;
+		const FTransform Transform = GetObstacleTransform(Obstacle);
+		const FBox LocalBox = Component->GetStaticMesh()->GetBoundingBox();
+		const FVector Center = Transform.TransformPosition(LocalBox.GetCenter());
+		const FVector Extent = LocalBox.GetExtent() * Transform.GetScale3D().GetAbs();
+
+		const FVector AxisX = Transform.GetUnitAxis(EAxis::X).GetSafeNormal2D();
+		const FVector AxisY = Transform.GetUnitAxis(EAxis::Y).GetSafeNormal2D();
+		if (FMath::Max(Extent.X, Extent.Y) * 2.0f > MaxObstacleSize || AxisX.IsNearlyZero() || AxisY.IsNearlyZero())
+		{
+			continue;
+		}
+
+		struct FSide
+		{
+			FVector Normal;
+			FVector Tangent;
+			float Depth;
+			float HalfWidth;
+		};
+		const FSide Sides[] =
+		{
+			{ AxisX, AxisY, Extent.X, Extent.Y },
+			{ -AxisX, AxisY, Extent.X, Extent.Y },
+			{ AxisY, AxisX, Extent.Y, Extent.X },
+			{ -AxisY, AxisX, Extent.Y, Extent.X },
+		};
+
+		for (const FSide& Side : Sides)
+		{
+			const int32 NumSamples = FMath::Max(1, FMath::FloorToInt(Side.HalfWidth * 2.0f / SampleSpacing));
+			for (int32 SampleIndex = 0; SampleIndex < NumSamples; SampleIndex++)
+			{
+				const float Offset = (SampleIndex + 0.5f) / NumSamples * Side.HalfWidth * 2.0f - Side.HalfWidth;
+				const FVector FacePoint = Center + Side.Normal * Side.Depth + Side.Tangent * Offset;
+
+				for (const float Angle : ApproachAngles)
+				{
+					const FVector Forward = (-Side.Normal).RotateAngleAxis(Angle, FVector::UpVector);
+					for (const float Distance : ApproachDistances)
+					{
+						const FVector Ground = FacePoint - Forward * Distance;
+
+						FHitResult FloorHit;
+						const FVector FloorTraceStart(Ground.X, Ground.Y, Center.Z + Extent.Z + CharacterHalfHeight);
+						const FVector FloorTraceEnd(Ground.X, Ground.Y, Center.Z - Extent.Z - 500.0f);
+						if (!Queries.LineTrace(TEXT("TraversalSim.Floor"), FloorTraceStart, FloorTraceEnd, NoActorsToIgnore, FloorHit)
+							|| (FloorHit.GetComponent() == Component && (Obstacle.InstanceIndex == INDEX_NONE || FloorHit.Item == Obstacle.InstanceIndex)))
+						{
+							continue;
+						}
+
+						FApproach Approach;
+						Approach.Origin = FloorHit.ImpactPoint + FVector(0.0f, 0.0f, CharacterHalfHeight);
+						Approach.Forward = Forward;
+						Approach.Angle = Angle;
+						Approach.Distance = Distance;
+						Approach.Obstacle = ObstacleIndex;
+
+						for (const float Speed : ApproachSpeeds)
+						{
+							Approach.Speed = Speed;
+							Approaches.Add(Approach);
+						}
+
+						// Speed does not matter in the air, the mantle path is taken either way.
+						FApproach Jump = Approach;
+						Jump.Speed = 0.0f;
+						Jump.bFalling = true;
+						for (const float JumpHeight : JumpHeights)
+						{
+							Jump.Origin.Z = Approach.Origin.Z + JumpHeight;
+							Approaches.Add(Jump);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Same choice and trace chains as Vaulting() followed by VaultTrace or MantleTrace, starting from empty results
+/// instead of whatever the character had left from the last attempt.
+/// </summary>
+Uparkour_GP4TraversalSimCommandlet::FDecision Uparkour_GP4TraversalSimCommandlet::Simulate(FParkourTraversalQueries& Queries, const FParkourVaultParams& InVaultParams, const FApproach& Approach) const
+{
+	FDecision Decision;
+	const uint32 QueriesBefore = Queries.GetNumQueries();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	if (ParkourTraversal::ShouldVault(Approach.Speed, Approach.bFalling))
+	{
+		FParkourVaultResult Result;
+		ParkourTraversal::AnalyzeVault(Queries, InVaultParams, Approach.Origin, Approach.Forward, Result);
+		Decision.Outcome = Result.CanVault && !Result.VaultLandLocation.IsZero() ? EOutcome::Vault : EOutcome::VaultBlocked;
+		Decision.VaultDistance = Result.VaultDistance;
+	}
+	else
+	{
+		FParkourMantleResult Result;
+		ParkourTraversal::AnalyzeMantle(Queries, MantleParams, Approach.Origin, Approach.Forward, Approach.bFalling, Result);
+		Decision.Outcome = Result.CanMantle ? EOutcome::Mantle : EOutcome::MantleBlocked;
+	}
+
+	Decision.Microseconds = static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0);
+	Decision.NumQueries = Queries.GetNumQueries() - QueriesBefore;
+
+	// Both chains stop after their first trace when it finds nothing.
+	if (Decision.NumQueries <= 1)
+	{
+		Decision.Outcome = EOutcome::NoObstacle;
+	}
+	return Decision;
+}
+
+const TCHAR* Uparkour_GP4TraversalSimCommandlet::GetOutcomeName(EOutcome Outcome)
+{
+	switch (Outcome)
+	{
+	case EOutcome::NoObstacle: return TEXT("NoObstacle");
+	case EOutcome::VaultBlocked: return TEXT("VaultBlocked");
+	case EOutcome::Vault: return TEXT("Vault");
+	case EOutcome::MantleBlocked: return TEXT("MantleBlocked");
+	case EOutcome::Mantle: return TEXT("Mantle");
+	default: return TEXT("");
+	}
+}
+
+void Uparkour_GP4TraversalSimCommandlet::WriteDecisions(const FString& OutputDir, const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions) const
+{
+	FString Csv = TEXT("Obstacle,X,Y,Z,Yaw,Angle,Distance,Speed,Falling,Outcome,VaultDistance,Queries,Microseconds\n");
+	Csv.Reserve(Decisions.Num() * 96);
+
+	for (int32 Index = 0; Index < Decisions.Num(); Index++)
+	{
+		const FApproach& Approach = Approaches[Index];
+		const FDecision& Decision = Decisions[Index];
+		Csv += FString::Printf(TEXT("%s,%.1f,%.1f,%.1f,%.1f,%.0f,%.0f,%.0f,%d,%s,%d,%u,%.2f\n"), *Obstacles[Approach.Obstacle].Name,
+			Approach.Origin.X, Approach.Origin.Y, Approach.Origin.Z, Approach.Forward.Rotation().Yaw, Approach.Angle, Approach.Distance, Approach.Speed,
+			Approach.bFalling ? 1 : 0, GetOutcomeName(Decision.Outcome), Decision.VaultDistance, Decision.NumQueries, Decision.Microseconds);
+	}
+
+	const FString CsvPath = OutputDir / TEXT("Decisions.csv");
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogParkourTraversalSim, Display, TEXT("Wrote %s"), *CsvPath);
+	}
+}
+
+/// <summary>
+/// Top down map of the approach origins around the map obstacles, one pixel per CoverageCellSize.
+/// Red, green and blue are the share of failed traversals, vaults and mantles of the approaches in that cell.
+/// Cells where nothing was in reach are dark grey, cells without approaches black.
+/// </summary>
+void Uparkour_GP4TraversalSimCommandlet::WriteCoverageMap(const FString& OutputDir, const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions) const
+{
+	FBox2D Bounds(ForceInit);
+	for (const FApproach& Approach : Approaches)
+	{
+		if (Obstacles[Approach.Obstacle].SyntheticSize.IsZero())
+		{
+			Bounds += FVector2D(Approach.Origin);
+		}
+	}
+	if (!Bounds.bIsValid)
+	{
+		return;
+	}
+
+	const int32 MaxPixels = 4096;
+	const FVector2D Size = Bounds.GetSize();
+	const float CellSize = FMath::Max3(CoverageCellSize, static_cast<float>(Size.X) / MaxPixels, static_cast<float>(Size.Y) / MaxPixels);
+	const int32 Width = FMath::FloorToInt(Size.X / CellSize) + 1;
+	const int32 Height = FMath::FloorToInt(Size.Y / CellSize) + 1;
+
+	struct FCell
+	{
+		int32 Counts[static_cast<int32>(EOutcome::Num)] = {};
+	};
+	TArray<FCell> Cells;
+	Cells.SetNum(Width * Height);
+
+	for (int32 Index = 0; Index < Approaches.Num(); Index++)
+	{
+		const FApproach& Approach = Approaches[Index];
+		if (!Obstacles[Approach.Obstacle].SyntheticSize.IsZero())
+		{
+			continue;
+		}
+
+		const int32 X = FMath::FloorToInt((Approach.Origin.X - Bounds.Min.X) / CellSize);
+		const int32 Y = FMath::FloorToInt((Approach.Origin.Y - Bounds.Min.Y) / CellSize);
+		Cells[Y * Width + X].Counts[static_cast<int32>(Decisions[Index].Outcome)]++;
+	}
+
+	TArray<FColor> Pixels;
+	Pixels.SetNumUninitialized(Width * Height);
+	for (int32 Index = 0; Index < Cells.Num(); Index++)
+	{
+		const int32* Cell = Cells[Index].Counts;
+		const int32 Failed = Cell[static_cast<int32>(EOutcome::VaultBlocked)] + Cell[static_cast<int32>(EOutcome::MantleBlocked)];
+		const int32 Vaults = Cell[static_cast<int32>(EOutcome::Vault)];
+		const int32 Mantles = Cell[static_cast<int32>(EOutcome::Mantle)];
+		const int32 Attempts = Failed + Vaults + Mantles;
+
+		if (Attempts > 0)
+		{
+			Pixels[Index] = FColor(255 * Failed / Attempts, 255 * Vaults / Attempts, 255 * Mantles / Attempts);
+		}
+		else
+		{
+			Pixels[Index] = Cell[static_cast<int32>(EOutcome::NoObstacle)] > 0 ? FColor(40, 40, 40) : FColor::Black;
+		}
+	}
+
+	FString Filename;
+	if (FFileHelper::CreateBitmap(*(OutputDir / TEXT("Coverage")), Width, Height, Pixels.GetData(), nullptr, &IFileManager::Get(), &Filename))
+	{
+		UE_LOG(LogParkourTraversalSim, Display, TEXT("Wrote %s, %dx%d pixels of %.0fcm from (%.0f, %.0f)"), *Filename, Width, Height, CellSize, Bounds.Min.X, Bounds.Min.Y);
+	}
+}
+
+void Uparkour_GP4TraversalSimCommandlet::WriteSizeCoverage(const FString& OutputDir, const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions) const
+{
+	struct FSizeStats
+	{
+		int32 Counts[static_cast<int32>(EOutcome::Num)] = {};
+		uint64 NumQueries = 0;
+		uint32 MaxQueries = 0;
+		double Microseconds = 0.0;
+		int32 NumDecisions = 0;
+	};
+
+	TArray<FSizeStats> Stats;
+	Stats.SetNum(Obstacles.Num());
+	for (int32 Index = 0; Index < Approaches.Num(); Index++)
+	{
+		FSizeStats& Stat = Stats[Approaches[Index].Obstacle];
+		const FDecision& Decision = Decisions[Index];
+		Stat.Counts[static_cast<int32>(Decision.Outcome)]++;
+		Stat.NumQueries += Decision.NumQueries;
+		Stat.MaxQueries = FMath::Max(Stat.MaxQueries, Decision.NumQueries);
+		Stat.Microseconds += Decision.Microseconds;
+		Stat.NumDecisions++;
+	}
+
+	FString Csv = TEXT("Depth,Height,Decisions,NoObstacle,VaultBlocked,Vault,MantleBlocked,Mantle,AvgQueries,MaxQueries,AvgMicroseconds\n");
+	bool bAnySynthetic = false;
+	for (int32 ObstacleIndex = 0; ObstacleIndex < Obstacles.Num(); ObstacleIndex++)
+	{
+		const FSizeStats& Stat = Stats[ObstacleIndex];
+		if (Obstacles[ObstacleIndex].SyntheticSize.IsZero() || Stat.NumDecisions == 0)
+		{
+			continue;
+		}
+
+		bAnySynthetic = true;
+		Csv += FString::Printf(TEXT("%.0f,%.0f,%d,%d,%d,%d,%d,%d,%.2f,%u,%.2f\n"),
+			Obstacles[ObstacleIndex].SyntheticSize.X, Obstacles[ObstacleIndex].SyntheticSize.Y, Stat.NumDecisions,
+			Stat.Counts[0], Stat.Counts[1], Stat.Counts[2], Stat.Counts[3], Stat.Counts[4],
+			double(Stat.NumQueries) / Stat.NumDecisions, Stat.MaxQueries, Stat.Microseconds / Stat.NumDecisions);
+	}
+
+	const FString CsvPath = OutputDir / TEXT("SizeCoverage.csv");
+	if (bAnySynthetic && FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogParkourTraversalSim, Display, TEXT("Wrote %s"), *CsvPath);
+	}
+}
+
+void Uparkour_GP4TraversalSimCommandlet::LogSummary(const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions, double Seconds) const
+{
+	UE_LOG(LogParkourTraversalSim, Display, TEXT("%d decisions in %.2fs, %.0f decisions per second"), Decisions.Num(), Seconds, Seconds > 0.0 ? Decisions.Num() / Seconds : 0.0);
+
+	// Query cost per outcome.
+	for (int32 OutcomeIndex = 0; OutcomeIndex < static_cast<int32>(EOutcome::Num); OutcomeIndex++)
+	{
+		int32 Count = 0;
+		uint64 NumQueries = 0;
+		uint32 MaxQueries = 0;
+		double Microseconds = 0.0;
+		for (const FDecision& Decision : Decisions)
+		{
+			if (static_cast<int32>(Decision.Outcome) == OutcomeIndex)
+			{
+				Count++;
+				NumQueries += Decision.NumQueries;
+				MaxQueries = FMath::Max(MaxQueries, Decision.NumQueries);
+				Microseconds += Decision.Microseconds;
+			}
+		}
+
+		if (Count > 0)
+		{
+			UE_LOG(LogParkourTraversalSim, Display, TEXT("  %-14s %8d decisions, %5.2f traces avg, %3u max, %7.2f us avg"),
+				GetOutcomeName(static_cast<EOutcome>(OutcomeIndex)), Count, double(NumQueries) / Count, MaxQueries, Microseconds / Count);
+		}
+	}
+
+	// Success rate by approach angle, only counting approaches that had something in reach.
+	for (const float Angle : ApproachAngles)
+	{
+		int32 Attempts = 0;
+		int32 Successes = 0;
+		for (int32 Index = 0; Index < Decisions.Num(); Index++)
+		{
+			const EOutcome Outcome = Decisions[Index].Outcome;
+			if (Approaches[Index].Angle == Angle && Outcome != EOutcome::NoObstacle)
+			{
+				Attempts++;
+				Successes += Outcome == EOutcome::Vault || Outcome == EOutcome::Mantle ? 1 : 0;
+			}
+		}
+		UE_LOG(LogParkourTraversalSim, Display, TEXT("  Angle %4.0f: %5.1f%% of %d traversals succeed"), Angle, Attempts ? 100.0 * Successes / Attempts : 0.0, Attempts);
+	}
+
+	// The most expensive decisions are the ones to look at first when tuning.
+	TArray<int32> Order;
+	Order.Reserve(Decisions.Num());
+	for (int32 Index = 0; Index < Decisions.Num(); Index++)
+	{
+		Order.Add(Index);
+	}
+	Order.Sort([&Decisions](int32 A, int32 B)
+	{
+		return Decisions[A].NumQueries != Decisions[B].NumQueries ? Decisions[A].NumQueries > Decisions[B].NumQueries : Decisions[A].Microseconds > Decisions[B].Microseconds;
+	});
+
+	const int32 NumSlowest = FMath::Min(10, Order.Num());
+	for (int32 i = 0; i < NumSlowest; i++)
+	{
+		const FApproach& Approach = Approaches[Order[i]];
+		const FDecision& Decision = Decisions[Order[i]];
+		UE_LOG(LogParkourTraversalSim, Display, TEXT("  Slow: %s %s at (%.0f, %.0f, %.0f) angle %.0f distance %.0f speed %.0f%s: %u traces, %.2f us"),
+			*Obstacles[Approach.Obstacle].Name, GetOutcomeName(Decision.Outcome), Approach.Origin.X, Approach.Origin.Y, Approach.Origin.Z,
+			Approach.Angle, Approach.Distance, Approach.Speed, Approach.bFalling ? TEXT(" falling") : TEXT(""), Decision.NumQueries, Decision.Microseconds);
+	}
+}
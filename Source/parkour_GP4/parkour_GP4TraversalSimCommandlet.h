@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalSimCommandlet.generated.h"
+
+class UStaticMeshComponent;
+class FParkourTraversalQueries;
+
+/**
+ * Headless traversal simulator. Runs the Vaulting() choice and the VaultTrace/MantleTrace chains for every combination of
+ * approach speed, angle, distance and jump height around every obstacle of a map, spread over the worker threads.
+ *
+ * UnrealEditor-Cmd parkour_GP4.uproject -run=parkour_GP4TraversalSim -Map=/Game/_Parkour/Maps/ParkourMap [-Synthetic] [-StressCourse=Seed] [-Linear] [-SingleThread]
+ *
+ * -Synthetic adds a generated box for every SyntheticDepths x SyntheticHeights combination away from the map, -StressCourse
+ * runs on a generated Aparkour_GP4StressCourse instead of the map's obstacles for a large and repeatable workload, -Linear runs the
+ * linear vault depth scan instead of the bisection, -SingleThread runs everything on the game thread for comparison.
+ * Results go to Saved/Profiling/TraversalSim: Decisions.csv with one row per decision, SizeCoverage.csv per synthetic obstacle
+ * and a top down Coverage bitmap of the map where red is a failed traversal, green a vault and blue a mantle.
+ * The map is not saved.
+ */
+UCLASS(config=Game)
+class Uparkour_GP4TraversalSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	Uparkour_GP4TraversalSimCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	enum class EOutcome : uint8
+	{
+		/** The first trace of the chain found nothing. */
+		NoObstacle,
+		VaultBlocked,
+		Vault,
+		MantleBlocked,
+		Mantle,
+		Num
+	};
+
+	struct FObstacle
+	{
+		UStaticMeshComponent* Component = nullptr;
+		FString Name;
+		/** Instance of an instanced static mesh, each one is an obstacle of its own. */
+		int32 InstanceIndex = INDEX_NONE;
+		/** Depth and height of a synthetic box, zero for map obstacles. */
+		FVector2D SyntheticSize = FVector2D::ZeroVector;
+	};
+
+	struct FApproach
+	{
+		FVector Origin = FVector::ZeroVector;
+		FVector Forward = FVector::ForwardVector;
+		float Angle = 0.0f;
+		float Distance = 0.0f;
+		float Speed = 0.0f;
+		bool bFalling = false;
+		int32 Obstacle = INDEX_NONE;
+	};
+
+	struct FDecision
+	{
+		EOutcome Outcome = EOutcome::NoObstacle;
+		int32 VaultDistance = 0;
+		uint32 NumQueries = 0;
+		float Microseconds = 0.0f;
+	};
+
+	/** Gathers the obstacles of the whole map, or only those of OnlyOwner when it is set. */
+	void GatherObstacles(UWorld* World, TArray<FObstacle>& Obstacles, const AActor* OnlyOwner = nullptr) const;
+	void SpawnSyntheticObstacles(UWorld* World, TArray<FObstacle>& Obstacles) const;
+	void BuildApproaches(FParkourTraversalQueries& Queries, const TArray<FObstacle>& Obstacles, TArray<FApproach>& Approaches) const;
+	FDecision Simulate(FParkourTraversalQueries& Queries, const FParkourVaultParams& InVaultParams, const FApproach& Approach) const;
+
+	void WriteDecisions(const FString& OutputDir, const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions) const;
+	void WriteCoverageMap(const FString& OutputDir, const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions) const;
+	void WriteSizeCoverage(const FString& OutputDir, const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions) const;
+	void LogSummary(const TArray<FObstacle>& Obstacles, const TArray<FApproach>& Approaches, const TArray<FDecision>& Decisions, double Seconds) const;
+
+	static const TCHAR* GetOutcomeName(EOutcome Outcome);
+	static FTransform GetObstacleTransform(const FObstacle& Obstacle);
+
+	/** Should match what the character Blueprint passes to VaultTrace. */
+	UPROPERTY(config)
+		FParkourVaultParams VaultParams;
+
+	/** Should match what the character Blueprint passes to MantleTrace. */
+	UPROPERTY(config)
+		FParkourMantleParams MantleParams;
+
+	/** Height of the character origin above the floor, the capsule half height. */
+	UPROPERTY(config)
+		float CharacterHalfHeight;
+
+	/** Distance between approach points along an obstacle face. */
+	UPROPERTY(config)
+		float SampleSpacing;
+
+	/** Components bigger than this horizontally are floors or walls, not obstacles. */
+	UPROPERTY(config)
+		float MaxObstacleSize;
+
+	/** Approach angles in degrees relative to running straight at the face. */
+	UPROPERTY(config)
+		TArray<float> ApproachAngles;
+
+	/** Distances from the face at which the decision is made, along the approach direction. */
+	UPROPERTY(config)
+		TArray<float> ApproachDistances;
+
+	/** Ground speeds, they pick between vault and mantle like Vaulting() does. */
+	UPROPERTY(config)
+		TArray<float> ApproachSpeeds;
+
+	/** Heights above standing height for approaches in the air, these always take the mantle path. */
+	UPROPERTY(config)
+		TArray<float> JumpHeights;
+
+	/** Sizes of the -Synthetic boxes. */
+	UPROPERTY(config)
+		TArray<float> SyntheticDepths;
+	UPROPERTY(config)
+		TArray<float> SyntheticHeights;
+
+	/** Size of one pixel of the coverage map in cm, grown if the map would get larger than 4096 pixels. */
+	UPROPERTY(config)
+		float CoverageCellSize;
+};
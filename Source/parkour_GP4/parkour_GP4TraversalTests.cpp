@@ -0,0 +1,520 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4StressCourse.h"
+#include "parkour_GP4TraversalAnalysis.h"
+#include "parkour_GP4TraversalPrefilter.h"
+#include "parkour_GP4TraversalQueries.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/OverlapResult.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ParkourTraversalTests
+{
+	/** The basic cube is 100cm on every side with its pivot in the middle. */
+	static const TCHAR* CubeMeshPath = TEXT("/Engine/BasicShapes/Cube.Cube");
+
+	/** Characters stand this far above the floor, like the default capsule. */
+	constexpr float CharacterHalfHeight = 96.0f;
+
+	/** Empty game world with a physics scene, destroyed with this object. Tests place box obstacles in it and trace against them. */
+	class FTestWorld
+	{
+	public:
+		FTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false);
+			CubeMesh = LoadObject<UStaticMesh>(nullptr, CubeMeshPath);
+		}
+
+		~FTestWorld()
+		{
+			World->RemoveFromRoot();
+			World->DestroyWorld(false);
+		}
+
+		bool IsValid() const { return World && CubeMesh; }
+
+		AStaticMeshActor* SpawnBox(const FVector& Center, const FVector& Size)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Center, FRotator::ZeroRotator, SpawnParams);
+			Box->SetMobility(EComponentMobility::Movable);
+			Box->GetStaticMeshComponent()->SetStaticMesh(CubeMesh);
+			Box->SetActorScale3D(Size / 100.0f);
+			return Box;
+		}
+
+		/** Floor with its top at Ground, large enough for every obstacle the tests place around Ground. */
+		AStaticMeshActor* SpawnFloor(const FVector& Ground)
+		{
+			return SpawnBox(Ground - FVector(0.0f, 0.0f, 50.0f), FVector(2000.0f, 2000.0f, 100.0f));
+		}
+
+		UWorld* World = nullptr;
+		UStaticMesh* CubeMesh = nullptr;
+	};
+
+	/** Sets a console variable for the scope and puts the previous value back afterwards. */
+	class FScopedConsoleVariable
+	{
+	public:
+		FScopedConsoleVariable(const TCHAR* Name, int32 Value)
+			: Variable(IConsoleManager::Get().FindConsoleVariable(Name))
+		{
+			if (Variable)
+			{
+				PreviousValue = Variable->GetInt();
+				Variable->Set(Value, ECVF_SetByCode);
+			}
+		}
+
+		~FScopedConsoleVariable()
+		{
+			if (Variable)
+			{
+				Variable->Set(PreviousValue, ECVF_SetByCode);
+			}
+		}
+
+		void Set(int32 Value)
+		{
+			if (Variable)
+			{
+				Variable->Set(Value, ECVF_SetByCode);
+			}
+		}
+
+		bool IsValid() const { return Variable != nullptr; }
+
+	private:
+		IConsoleVariable* Variable = nullptr;
+		int32 PreviousValue = 0;
+	};
+
+	/** True if both mantle results would make the character do the same mantle. */
+	bool MantleResultsMatch(const FParkourMantleResult& A, const FParkourMantleResult& B)
+	{
+		return A.CanMantle == B.CanMantle
+			&& (!A.CanMantle
+				|| (A.MantlePosition1.Equals(B.MantlePosition1, 1.0f) && A.MantlePosition2.Equals(B.MantlePosition2, 1.0f)));
+	}
+
+	/**
+	 * Counts the allocations made on one thread while it is installed as GMalloc, everything is passed on to the real allocator.
+	 * Only sees allocations that go through GMalloc, which is all of them on desktop platforms.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		void Install(uint32 InThreadId)
+		{
+			Inner = GMalloc;
+			ThreadId = InThreadId;
+			NumAllocations = 0;
+			GMalloc = this;
+		}
+
+		void Uninstall()
+		{
+			// Other threads may still be inside one of the calls below, so Inner stays valid and this object is never destroyed.
+			GMalloc = Inner;
+		}
+
+		uint64 GetNumAllocations() const { return NumAllocations; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->Realloc(Original, Count, Alignment); }
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { CountAllocation(); return Inner->TryRealloc(Original, Count, Alignment); }
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override { Inner->MarkTLSCachesAsUsedOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override { Inner->MarkTLSCachesAsUnusedOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		void CountAllocation()
+		{
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				NumAllocations++;
+			}
+		}
+
+		FMalloc* Inner = nullptr;
+		uint32 ThreadId = 0;
+		uint64 NumAllocations = 0;
+	};
+
+	/** Counts the allocations the current thread makes during the scope. */
+	class FScopedAllocationCounter
+	{
+	public:
+		FScopedAllocationCounter()
+		{
+			GetCountingMalloc().Install(FPlatformTLS::GetCurrentThreadId());
+		}
+
+		~FScopedAllocationCounter()
+		{
+			Stop();
+		}
+
+		/** Stops counting and returns the number of allocations, later calls return the same. */
+		uint64 Stop()
+		{
+			if (!bStopped)
+			{
+				GetCountingMalloc().Uninstall();
+				bStopped = true;
+			}
+			return GetCountingMalloc().GetNumAllocations();
+		}
+
+	private:
+		/** Kept alive for good, another thread may still be calling into it after it was uninstalled. */
+		static FCountingMalloc& GetCountingMalloc()
+		{
+			static FCountingMalloc CountingMalloc;
+			return CountingMalloc;
+		}
+
+		bool bStopped = false;
+	};
+}
+
+using namespace ParkourTraversalTests;
+
+/// <summary>
+/// Runs the linear and the bisection vault depth search against box obstacles over a grid of depths, heights and approach distances.
+/// Both have to make the same vault decision for every obstacle, and some of the obstacles have to be vaultable so the grid means something.
+/// Every search runs once from an empty result and once from a vault left over from an earlier search, which obstacles deeper than the probe range keep.
+/// </summary>
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourVaultDepthSearchTest, "Parkour.Traversal.VaultDepthSearch",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FParkourVaultDepthSearchTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	if (!TestTrue(TEXT("Test world and cube mesh"), TestWorld.IsValid()))
+	{
+		return false;
+	}
+
+	const FVector Ground(0.0f, 0.0f, 100000.0f);
+	TestWorld.SpawnFloor(Ground);
+
+	FParkourTraversalQueries Queries(TestWorld.World);
+	FParkourVaultParams Params;
+
+	FParkourVaultResult EarlierVault;
+	EarlierVault.VaultStartLocation = Ground + FVector(-500.0f, 0.0f, 100.0f);
+	EarlierVault.VaultMiddleLocation = Ground + FVector(-450.0f, 0.0f, 100.0f);
+	EarlierVault.VaultLandLocation = Ground + FVector(-350.0f, 0.0f, 0.0f);
+	EarlierVault.VaultDistance = 3;
+	EarlierVault.CanVault = true;
+
+	const FParkourVaultResult StartingResults[] = { FParkourVaultResult(), EarlierVault };
+	const float Heights[] = { 60.0f, 100.0f, 140.0f };
+	const float ApproachDistances[] = { 40.0f, 100.0f, 160.0f };
+
+	auto CompareSearches = [&](const FString& Case, const FVector& Origin, const FParkourVaultResult& StartingResult, FParkourVaultResult& OutLinearResult)
+	{
+		OutLinearResult = StartingResult;
+		Params.bBisectDepth = false;
+		ParkourTraversal::AnalyzeVault(Queries, Params, Origin, FVector::ForwardVector, OutLinearResult);
+
+		FParkourVaultResult BisectionResult = StartingResult;
+		Params.bBisectDepth = true;
+		ParkourTraversal::AnalyzeVault(Queries, Params, Origin, FVector::ForwardVector, BisectionResult);
+
+		if (!ParkourTraversal::VaultResultsMatch(OutLinearResult, BisectionResult))
+		{
+			AddError(FString::Printf(TEXT("%s, starting from CanVault %d: linear CanVault %d distance %d, bisection CanVault %d distance %d"),
+				*Case, StartingResult.CanVault, OutLinearResult.CanVault, OutLinearResult.VaultDistance, BisectionResult.CanVault, BisectionResult.VaultDistance));
+		}
+	};
+
+	int32 NumCases = 0;
+	int32 NumVaults = 0;
+	int32 NumBeyondRange = 0;
+	for (int32 Depth = 10; Depth <= 400; Depth += 5)
+	{
+		for (const float Height : Heights)
+		{
+			AStaticMeshActor* Obstacle = TestWorld.SpawnBox(Ground + FVector(Depth * 0.5f, 0.0f, Height * 0.5f), FVector(Depth, 200.0f, Height));
+
+			for (const float ApproachDistance : ApproachDistances)
+			{
+				const FVector Origin = Ground + FVector(-ApproachDistance, 0.0f, CharacterHalfHeight);
+				const FString Case = FString::Printf(TEXT("Depth %dcm, height %.0fcm, approach %.0fcm"), Depth, Height, ApproachDistance);
+
+				for (const FParkourVaultResult& StartingResult : StartingResults)
+				{
+					FParkourVaultResult LinearResult;
+					CompareSearches(Case, Origin, StartingResult, LinearResult);
+
+					NumCases++;
+					NumVaults += LinearResult.bVaultFound ? 1 : 0;
+					NumBeyondRange += !LinearResult.bVaultFound && LinearResult.VaultDistance == Params.MaxDepthSteps ? 1 : 0;
+				}
+			}
+
+			Obstacle->Destroy();
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("%d searches, %d vaults, %d beyond the probe range"), NumCases, NumVaults, NumBeyondRange));
+	TestTrue(TEXT("Some obstacles are vaultable"), NumVaults > 0);
+	TestTrue(TEXT("Some obstacles are not vaultable"), NumVaults < NumCases);
+	TestTrue(TEXT("Some obstacles are deeper than the probe range"), NumBeyondRange > 0);
+
+	// Deeper than the probe range with a bar right where the height clearance probes go, which cancels the earlier vault.
+	const float DeepObstacleDepth = Params.MaxDepthSteps * Params.SecondaryTraceGap + 200.0f;
+	TestWorld.SpawnBox(Ground + FVector(DeepObstacleDepth * 0.5f, 0.0f, 60.0f), FVector(DeepObstacleDepth, 200.0f, 120.0f));
+	TestWorld.SpawnBox(Ground + FVector(DeepObstacleDepth * 0.5f + 60.0f, 0.0f, CharacterHalfHeight + Params.SecondaryTraceZOffset), FVector(DeepObstacleDepth, 200.0f, 10.0f));
+
+	FParkourVaultResult BlockedResult;
+	CompareSearches(TEXT("Deep obstacle under a bar"), Ground + FVector(-100.0f, 0.0f, CharacterHalfHeight), EarlierVault, BlockedResult);
+	TestFalse(TEXT("Bar over a deep obstacle cancels the earlier vault"), BlockedResult.CanVault);
+	return true;
+}
+
+/// <summary>
+/// Runs the vault and mantle analysis against the same box obstacles at the lowest and the highest shape complexity.
+/// The lowest one may only make the queries cheaper, both have to find the same vaults and mantles.
+/// </summary>
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourTraversalShapeComplexityTest, "Parkour.Traversal.ShapeComplexity",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FParkourTraversalShapeComplexityTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	if (!TestTrue(TEXT("Test world and cube mesh"), TestWorld.IsValid()))
+	{
+		return false;
+	}
+
+	FScopedConsoleVariable ShapeComplexity(TEXT("parkour.Traversal.ShapeComplexity"), 2);
+	if (!TestTrue(TEXT("parkour.Traversal.ShapeComplexity exists"), ShapeComplexity.IsValid()))
+	{
+		return false;
+	}
+
+	const FVector Ground(0.0f, 0.0f, 100000.0f);
+	TestWorld.SpawnFloor(Ground);
+
+	FParkourTraversalQueries Queries(TestWorld.World);
+	const FParkourVaultParams VaultParams;
+	const FParkourMantleParams MantleParams;
+	const FVector Origin = Ground + FVector(-100.0f, 0.0f, CharacterHalfHeight);
+
+	const float Depths[] = { 40.0f, 110.0f, 200.0f };
+	const float Heights[] = { 110.0f, 140.0f, 180.0f, 250.0f };
+
+	int32 NumVaults = 0;
+	int32 NumMantles = 0;
+	for (const float Depth : Depths)
+	{
+		for (const float Height : Heights)
+		{
+			AStaticMeshActor* Obstacle = TestWorld.SpawnBox(Ground + FVector(Depth * 0.5f, 0.0f, Height * 0.5f), FVector(Depth, 200.0f, Height));
+
+			FParkourVaultResult ExactVault;
+			FParkourMantleResult ExactMantle;
+			ShapeComplexity.Set(2);
+			ParkourTraversal::AnalyzeVault(Queries, VaultParams, Origin, FVector::ForwardVector, ExactVault);
+			ParkourTraversal::AnalyzeMantle(Queries, MantleParams, Origin, FVector::ForwardVector, false, ExactMantle);
+
+			FParkourVaultResult CheapVault;
+			FParkourMantleResult CheapMantle;
+			ShapeComplexity.Set(0);
+			ParkourTraversal::AnalyzeVault(Queries, VaultParams, Origin, FVector::ForwardVector, CheapVault);
+			ParkourTraversal::AnalyzeMantle(Queries, MantleParams, Origin, FVector::ForwardVector, false, CheapMantle);
+
+			NumVaults += ExactVault.CanVault ? 1 : 0;
+			NumMantles += ExactMantle.CanMantle ? 1 : 0;
+			if (!ParkourTraversal::VaultResultsMatch(ExactVault, CheapVault))
+			{
+				AddError(FString::Printf(TEXT("Depth %.0fcm, height %.0fcm: vault with shapes CanVault %d distance %d, with lines CanVault %d distance %d"),
+					Depth, Height, ExactVault.CanVault, ExactVault.VaultDistance, CheapVault.CanVault, CheapVault.VaultDistance));
+			}
+			if (!MantleResultsMatch(ExactMantle, CheapMantle))
+			{
+				AddError(FString::Printf(TEXT("Depth %.0fcm, height %.0fcm: mantle with shapes CanMantle %d at %s, with lines CanMantle %d at %s"),
+					Depth, Height, ExactMantle.CanMantle, *ExactMantle.MantlePosition2.ToString(), CheapMantle.CanMantle, *CheapMantle.MantlePosition2.ToString()));
+			}
+
+			Obstacle->Destroy();
+		}
+	}
+
+	TestTrue(TEXT("Some obstacles are vaultable"), NumVaults > 0);
+	TestTrue(TEXT("Some obstacles are mantleable"), NumMantles > 0);
+	return true;
+}
+
+/// <summary>
+/// A character standing on an empty floor has nothing in reach, so the prefilter has to skip the chains.
+/// Once a box is put in front of it the chains have to run again.
+/// </summary>
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourTraversalPrefilterFloorTest, "Parkour.Traversal.PrefilterIgnoresFloor",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FParkourTraversalPrefilterFloorTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	if (!TestTrue(TEXT("Test world and cube mesh"), TestWorld.IsValid()))
+	{
+		return false;
+	}
+
+	const FVector Ground(0.0f, 0.0f, 100000.0f);
+	TestWorld.SpawnFloor(Ground);
+
+	FParkourTraversalQueries Queries(TestWorld.World);
+	FParkourTraversalPrefilter Prefilter;
+	const FParkourVaultParams Params;
+	const FVector Origin = Ground + FVector(0.0f, 0.0f, CharacterHalfHeight);
+
+	TestFalse(TEXT("Nothing in reach on an empty floor"), Prefilter.HasTraversablesInReach(Queries, Origin, FVector::ForwardVector, Params.InitialTraceLength));
+
+	TestWorld.SpawnBox(Ground + FVector(150.0f, 0.0f, 50.0f), FVector(100.0f, 200.0f, 100.0f));
+	Prefilter.Invalidate();
+	TestTrue(TEXT("Box in front is in reach"), Prefilter.HasTraversablesInReach(Queries, Origin, FVector::ForwardVector, Params.InitialTraceLength));
+	return true;
+}
+
+/// <summary>
+/// Generates stress courses in two places with the same seed, which have to have the same layout, and again with another seed, which has to change it.
+/// </summary>
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourStressCourseLayoutTest, "Parkour.Traversal.StressCourseLayout",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FParkourStressCourseLayoutTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	if (!TestTrue(TEXT("Test world and cube mesh"), TestWorld.IsValid()))
+	{
+		return false;
+	}
+
+	auto SpawnCourse = [&TestWorld](const FVector& Location, int32 Seed)
+	{
+		const FTransform SpawnTransform(Location);
+		Aparkour_GP4StressCourse* Course = TestWorld.World->SpawnActorDeferred<Aparkour_GP4StressCourse>(Aparkour_GP4StressCourse::StaticClass(), SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		Course->Seed = Seed;
+		Course->Lanes = 2;
+		Course->SectionsPerLane = 20;
+		Course->FinishSpawning(SpawnTransform);
+		return Course;
+	};
+
+	Aparkour_GP4StressCourse* Course = SpawnCourse(FVector::ZeroVector, 7);
+	if (!TestTrue(TEXT("Stress course meshes"), Course->CubeMesh && Course->RampMesh))
+	{
+		return false;
+	}
+	Aparkour_GP4StressCourse* SameSeedCourse = SpawnCourse(FVector(0.0f, 50000.0f, 0.0f), 7);
+
+	const uint32 LayoutHash = Course->GetLayoutHash();
+	TestEqual(TEXT("Same seed gives the same layout"), SameSeedCourse->GetLayoutHash(), LayoutHash);
+
+	SameSeedCourse->Generate();
+	TestEqual(TEXT("Generating again gives the same layout"), SameSeedCourse->GetLayoutHash(), LayoutHash);
+
+	SameSeedCourse->Seed = 8;
+	SameSeedCourse->Generate();
+	TestNotEqual(TEXT("Another seed gives another layout"), SameSeedCourse->GetLayoutHash(), LayoutHash);
+	return true;
+}
+
+/// <summary>
+/// Runs every kind of traversal query and the full vault and mantle chains against a box obstacle, first a few times to warm up
+/// and then counting the allocations on the game thread. None of them may allocate once warmed up.
+/// </summary>
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourTraversalQueryAllocationsTest, "Parkour.Traversal.QueryAllocations",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FParkourTraversalQueryAllocationsTest::RunTest(const FString& Parameters)
+{
+	FTestWorld TestWorld;
+	if (!TestTrue(TEXT("Test world and cube mesh"), TestWorld.IsValid()))
+	{
+		return false;
+	}
+
+	const int32 Iterations = 100;
+	const int32 WarmupIterations = 8;
+
+	const FVector Ground(0.0f, 0.0f, 100000.0f);
+	const FVector Origin = Ground + FVector(-100.0f, 0.0f, CharacterHalfHeight);
+	AStaticMeshActor* Floor = TestWorld.SpawnFloor(Ground);
+	TestWorld.SpawnBox(Ground + FVector(50.0f, 0.0f, 50.0f), FVector(100.0f, 200.0f, 100.0f));
+
+	// Owned by an actor like a character's queries, so the self ignore path is taken as well.
+	FParkourTraversalQueries Queries(TestWorld.World->GetWorldSettings());
+	FParkourIgnoreActors FloorIgnore;
+	FloorIgnore.Add(Floor);
+	TArray<FOverlapResult> Overlaps;
+
+	FParkourVaultParams VaultParams;
+	FParkourMantleParams MantleParams;
+	FParkourVaultResult VaultResult;
+	FParkourMantleResult MantleResult;
+	FHitResult Hit;
+
+	const TPair<const TCHAR*, TFunction<void()>> Cases[] =
+	{
+		{ TEXT("LineTrace"), [&]() { Queries.LineTrace(TEXT("Allocations"), Origin, Origin + FVector(180.0f, 0.0f, 0.0f), FParkourIgnoreActors(), Hit); } },
+		{ TEXT("SphereTrace"), [&]() { Queries.SphereTrace(TEXT("Allocations"), Ground + FVector(50.0f, 0.0f, 200.0f), Ground + FVector(50.0f, 0.0f, 0.0f), 10.0f, FParkourIgnoreActors(), Hit); } },
+		{ TEXT("SphereTrace overlap"), [&]() { Queries.SphereTrace(TEXT("Allocations"), Ground + FVector(50.0f, 0.0f, 100.0f), Ground + FVector(50.0f, 0.0f, 100.0f), 20.0f, FParkourIgnoreActors(), Hit); } },
+		{ TEXT("SphereTrace ignoring the floor"), [&]() { Queries.SphereTrace(TEXT("Allocations"), Origin - FVector(0.0f, 0.0f, 90.0f), Origin - FVector(0.0f, 0.0f, 90.0f), 20.0f, FloorIgnore, Hit); } },
+		{ TEXT("CapsuleTrace"), [&]() { Queries.CapsuleTrace(TEXT("Allocations"), Origin, Origin, 34.0f, 50.0f, FParkourIgnoreActors(), Hit); } },
+		{ TEXT("BoxOverlapBlocking"), [&]() { Queries.BoxOverlapBlocking(TEXT("Allocations"), Origin, FVector(280.0f, 280.0f, 100.0f), Overlaps); } },
+		{ TEXT("Vault chain"), [&]() { ParkourTraversal::AnalyzeVault(Queries, VaultParams, Origin, FVector::ForwardVector, VaultResult); } },
+		{ TEXT("Mantle chain"), [&]() { ParkourTraversal::AnalyzeMantle(Queries, MantleParams, Origin, FVector::ForwardVector, false, MantleResult); } },
+	};
+
+	for (const TPair<const TCHAR*, TFunction<void()>>& Case : Cases)
+	{
+		for (int32 i = 0; i < WarmupIterations; i++)
+		{
+			Case.Value();
+		}
+
+		const uint32 QueriesBefore = Queries.GetNumQueries();
+		FScopedAllocationCounter AllocationCounter;
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			Case.Value();
+		}
+		const uint64 NumAllocations = AllocationCounter.Stop();
+
+		const uint32 NumQueries = Queries.GetNumQueries() - QueriesBefore;
+		TestTrue(FString::Printf(TEXT("%s made queries"), Case.Key), NumQueries > 0);
+		if (NumAllocations > 0)
+		{
+			AddError(FString::Printf(TEXT("%s: %llu allocations in %u queries"), Case.Key, NumAllocations, NumQueries));
+		}
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
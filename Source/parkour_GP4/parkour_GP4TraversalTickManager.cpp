@@ -0,0 +1,418 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "parkour_GP4TraversalTickManager.h"
+#include "parkour_GP4Character.h"
+#include "parkour_GP4TraversalAsyncTick.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+static TAutoConsoleVariable<bool> CVarTraversalTickBatched(
+	TEXT("parkour.TraversalTick.Batched"),
+	true,
+	TEXT("Run the slide timers and the sprint state machine of all parkour characters in one batched pass. 0 uses per character timers and movement ticks."));
+
+static TAutoConsoleVariable<int32> CVarTraversalTickMaxSlideCalls(
+	TEXT("parkour.TraversalTick.MaxSlideCalls"),
+	64,
+	TEXT("Maximum number of calls of one slide timer per frame, or per physics step with parkour.TraversalTick.Fixed. Further expired intervals are skipped."));
+
+static TAutoConsoleVariable<bool> CVarTraversalTickFixed(
+	TEXT("parkour.TraversalTick.Fixed"),
+	false,
+	TEXT("Step the slide timers and sprint state machines once per physics step instead of once per frame, on the physics thread when physics ticks async.\n")
+	TEXT("Turn on Tick Physics Async in the project's physics settings for a fixed rate. Needs parkour.TraversalTick.Batched."));
+
+bool Uparkour_GP4TraversalTickManager::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld();
+}
+
+void Uparkour_GP4TraversalTickManager::Deinitialize()
+{
+	SetFixedStep(false);
+	SetSprintBatched(false);
+	while (Characters.Num() > 0)
+	{
+		RemoveAt(Characters.Num() - 1);
+	}
+
+	Super::Deinitialize();
+}
+
+bool Uparkour_GP4TraversalTickManager::IsBatchingEnabled()
+{
+	return CVarTraversalTickBatched.GetValueOnGameThread();
+}
+
+int32 Uparkour_GP4TraversalTickManager::GetMaxSlideCalls()
+{
+	return FMath::Max(CVarTraversalTickMaxSlideCalls.GetValueOnGameThread(), 1);
+}
+
+/// <summary>
+/// Like a looping FTimerManager timer the function is owed one call for every interval that passed, so a 1ms timer is called about 16 times in a 60Hz frame.
+/// Intervals past MaxCalls are skipped, the countdown keeps its phase either way.
+/// </summary>
+int32 Uparkour_GP4TraversalTickManager::StepSlideTimer(float& TimeLeft, float Interval, float DeltaTime, int32 MaxCalls)
+{
+	if (Interval < 0.0f)
+	{
+		return 0;
+	}
+
+	TimeLeft -= DeltaTime;
+	if (TimeLeft > 0.0f)
+	{
+		return 0;
+	}
+
+	if (Interval <= KINDA_SMALL_NUMBER)
+	{
+		TimeLeft = 0.0f;
+		return 1;
+	}
+
+	const int32 NumExpired = FMath::FloorToInt(-TimeLeft / Interval) + 1;
+	TimeLeft += NumExpired * Interval;
+	return FMath::Min(NumExpired, MaxCalls);
+}
+
+void Uparkour_GP4TraversalTickManager::Register(Aparkour_GP4Character* Character)
+{
+	if (Character->TraversalTickIndex != INDEX_NONE)
+	{
+		return;
+	}
+
+	Character->TraversalTickIndex = Characters.Add(Character);
+	for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+	{
+		SlideTimeLeft[Timer].Add(0.0f);
+		SlideInterval[Timer].Add(-1.0f);
+		SlideCalls[Timer].Add(0);
+		SlideRestarted[Timer].Add(false);
+		SlideRestartSerial[Timer].Add(0);
+	}
+
+	if (bSprintBatched)
+	{
+		Character->GetParkourMovement()->bSprintStateBatched = true;
+	}
+}
+
+void Uparkour_GP4TraversalTickManager::Unregister(Aparkour_GP4Character* Character)
+{
+	if (Characters.IsValidIndex(Character->TraversalTickIndex) && Characters[Character->TraversalTickIndex] == Character)
+	{
+		RemoveAt(Character->TraversalTickIndex);
+	}
+}
+
+void Uparkour_GP4TraversalTickManager::RemoveAt(int32 Index)
+{
+	if (Aparkour_GP4Character* Character = Characters[Index].Get())
+	{
+		Character->TraversalTickIndex = INDEX_NONE;
+		if (Uparkour_GP4MovementComponent* Movement = Character->GetParkourMovement())
+		{
+			Movement->bSprintStateBatched = false;
+		}
+	}
+
+	Characters.RemoveAtSwap(Index, 1, false);
+	for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+	{
+		SlideTimeLeft[Timer].RemoveAtSwap(Index, 1, false);
+		SlideInterval[Timer].RemoveAtSwap(Index, 1, false);
+		SlideCalls[Timer].RemoveAtSwap(Index, 1, false);
+		SlideRestarted[Timer].RemoveAtSwap(Index, 1, false);
+		SlideRestartSerial[Timer].RemoveAtSwap(Index, 1, false);
+	}
+
+	// The last character moved into the freed slot.
+	if (Characters.IsValidIndex(Index))
+	{
+		if (Aparkour_GP4Character* Moved = Characters[Index].Get())
+		{
+			Moved->TraversalTickIndex = Index;
+		}
+	}
+}
+
+void Uparkour_GP4TraversalTickManager::StartSlideTimer(Aparkour_GP4Character* Character, EParkourSlideTimer Timer, float Interval)
+{
+	Register(Character);
+
+	const int32 Index = Character->TraversalTickIndex;
+	SlideTimeLeft[static_cast<int32>(Timer)][Index] = Interval;
+	SlideInterval[static_cast<int32>(Timer)][Index] = Interval;
+	SlideCalls[static_cast<int32>(Timer)][Index] = 0;
+
+	// Steps that ran before the physics thread hears about the restart must not fire the timer.
+	SlideRestarted[static_cast<int32>(Timer)][Index] = true;
+	SlideRestartSerial[static_cast<int32>(Timer)][Index] = AsyncInputSerial + 1;
+}
+
+void Uparkour_GP4TraversalTickManager::StopSlideTimer(Aparkour_GP4Character* Character, EParkourSlideTimer Timer)
+{
+	const int32 Index = Character->TraversalTickIndex;
+	if (Characters.IsValidIndex(Index))
+	{
+		SlideInterval[static_cast<int32>(Timer)][Index] = -1.0f;
+		SlideCalls[static_cast<int32>(Timer)][Index] = 0;
+	}
+}
+
+bool Uparkour_GP4TraversalTickManager::IsSlideTimerActive(const Aparkour_GP4Character* Character, EParkourSlideTimer Timer) const
+{
+	const int32 Index = Character->TraversalTickIndex;
+	return Characters.IsValidIndex(Index) && SlideInterval[static_cast<int32>(Timer)][Index] >= 0.0f;
+}
+
+void Uparkour_GP4TraversalTickManager::SetSprintBatched(bool bBatched)
+{
+	if (bSprintBatched == bBatched)
+	{
+		return;
+	}
+
+	bSprintBatched = bBatched;
+	for (const TWeakObjectPtr<Aparkour_GP4Character>& Character : Characters)
+	{
+		if (Character.IsValid())
+		{
+			Character->GetParkourMovement()->bSprintStateBatched = bBatched;
+		}
+	}
+}
+
+/// <summary>
+/// Steps the sprint state machines and the slide timers of all characters in one pass, then calls the slide functions whose timers expired.
+/// </summary>
+void Uparkour_GP4TraversalTickManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SetSprintBatched(IsBatchingEnabled());
+	SetFixedStep(bSprintBatched && CVarTraversalTickFixed.GetValueOnGameThread());
+	if (AsyncCallback)
+	{
+		TickFixed();
+		return;
+	}
+
+	for (int32 Index = 0; Index < Characters.Num(); Index++)
+	{
+		Uparkour_GP4Character* Character = Characters[Index].Get();
+		Uparkour_GP4MovementComponent* Movement = Character ? Character->GetParkourMovement() : nullptr;
+		if (!bSprintBatched || Movement == nullptr || !Movement->ShouldUpdateSprintState())
+		{
+			continue;
+		}
+
+		const float Speed2D = Movement->Velocity.Size2D();
+		const bool bMoving = Speed2D > Movement->SprintStartMinSpeed && !Movement->GetCurrentAcceleration().IsZero();
+		const EParkourSprintState NewState = Uparkour_GP4MovementComponent::AdvanceSprintState(Movement->GetSprintState(), Movement->GetTimeInSprintState() + DeltaTime, Speed2D,
+			bMoving, Movement->WantsToSprint(), Movement->IsFalling(), Movement->SprintSustainTime, Movement->RunToStopMinSpeed);
+		Movement->ApplySprintStep(DeltaTime, bMoving, NewState);
+	}
+
+	const int32 MaxSlideCalls = GetMaxSlideCalls();
+	for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+	{
+		for (int32 Index = 0; Index < Characters.Num(); Index++)
+		{
+			SlideCalls[Timer][Index] = StepSlideTimer(SlideTimeLeft[Timer][Index], SlideInterval[Timer][Index], DeltaTime, MaxSlideCalls);
+		}
+	}
+
+	for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+	{
+		CallDueSlideTimers(static_cast<EParkourSlideTimer>(Timer), 0.0f);
+	}
+}
+
+/// <summary>
+/// StepDeltaTime is passed on to the slide functions for their interpolation, zero lets them use the frame time.
+/// </summary>
+void Uparkour_GP4TraversalTickManager::CallDueSlideTimers(EParkourSlideTimer Timer, float StepDeltaTime)
+{
+	const int32 TimerIndex = static_cast<int32>(Timer);
+
+	// The slide functions start and stop timers and may unregister characters, so the due characters are collected first.
+	DueCharacters.Reset();
+	for (int32 Index = 0; Index < Characters.Num(); Index++)
+	{
+		if (SlideCalls[TimerIndex][Index] > 0)
+		{
+			DueCharacters.Add(Characters[Index]);
+		}
+	}
+
+	// The index is looked up again for every call, it changes when another character unregisters.
+	for (const TWeakObjectPtr<Aparkour_GP4Character>& DueCharacter : DueCharacters)
+	{
+		Aparkour_GP4Character* Character = DueCharacter.Get();
+		while (Character && Characters.IsValidIndex(Character->TraversalTickIndex) && SlideCalls[TimerIndex][Character->TraversalTickIndex] > 0)
+		{
+			SlideCalls[TimerIndex][Character->TraversalTickIndex]--;
+			Character->SlideStepDeltaTime = StepDeltaTime;
+			Character->OnSlideTimer(Timer);
+			Character->SlideStepDeltaTime = 0.0f;
+			Character = DueCharacter.Get();
+		}
+	}
+}
+
+void Uparkour_GP4TraversalTickManager::SetFixedStep(bool bFixed)
+{
+	if ((AsyncCallback != nullptr) == bFixed)
+	{
+		return;
+	}
+
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	Chaos::FPhysicsSolver* Solver = PhysScene ? PhysScene->GetSolver() : nullptr;
+
+	if (bFixed)
+	{
+		if (Solver == nullptr)
+		{
+			return;
+		}
+
+		if (!UPhysicsSettings::Get()->bTickPhysicsAsync)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("parkour.TraversalTick.Fixed steps with the physics step, which follows the frame rate until Tick Physics Async is turned on"));
+		}
+		AsyncCallback = Solver->CreateAndRegisterSimCallbackObject_External<FParkourTraversalAsyncCallback>();
+
+		// Running timers start over on the physics thread.
+		for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+		{
+			for (int32 Index = 0; Index < Characters.Num(); Index++)
+			{
+				SlideRestarted[Timer][Index] = SlideInterval[Timer][Index] >= 0.0f;
+				SlideRestartSerial[Timer][Index] = AsyncInputSerial + 1;
+			}
+		}
+	}
+	else
+	{
+		if (Solver)
+		{
+			Solver->UnregisterAndFreeSimCallbackObject_External(AsyncCallback);
+		}
+		AsyncCallback = nullptr;
+
+		// And start over on the game thread.
+		for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+		{
+			SlideTimeLeft[Timer] = SlideInterval[Timer];
+		}
+	}
+}
+
+/// <summary>
+/// Applies the results of every physics step since the last frame in order, each with the step's delta time,
+/// then sends this frame's snapshot for the steps to come.
+/// </summary>
+void Uparkour_GP4TraversalTickManager::TickFixed()
+{
+	while (Chaos::TSimCallbackOutputHandle<FParkourTraversalAsyncOutput> Output = AsyncCallback->PopOutputData_External())
+	{
+		ApplyAsyncOutput(*Output);
+	}
+
+	SendAsyncInput();
+}
+
+void Uparkour_GP4TraversalTickManager::ApplyAsyncOutput(const FParkourTraversalAsyncOutput& Output)
+{
+	for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+	{
+		FMemory::Memzero(SlideCalls[Timer].GetData(), SlideCalls[Timer].Num() * sizeof(int32));
+	}
+
+	for (int32 OutputIndex = 0; OutputIndex < Output.Characters.Num(); OutputIndex++)
+	{
+		Aparkour_GP4Character* Character = Output.Characters[OutputIndex].Get();
+		if (Character == nullptr || !Characters.IsValidIndex(Character->TraversalTickIndex))
+		{
+			continue;
+		}
+
+		const int32 Index = Character->TraversalTickIndex;
+		const FParkourTraversalAsyncResult& Result = Output.Results[OutputIndex];
+		if (Result.bSprintSimulated)
+		{
+			Character->GetParkourMovement()->ApplySprintStep(Output.DeltaTime, Result.bMovingWithInput, Result.SprintState);
+		}
+
+		for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+		{
+			const bool bCurrent = SlideInterval[Timer][Index] >= 0.0f && Output.InputSerial >= SlideRestartSerial[Timer][Index];
+			SlideCalls[Timer][Index] = bCurrent ? Result.SlideCalls[Timer] : 0;
+		}
+	}
+
+	for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+	{
+		CallDueSlideTimers(static_cast<EParkourSlideTimer>(Timer), Output.DeltaTime);
+	}
+}
+
+void Uparkour_GP4TraversalTickManager::SendAsyncInput()
+{
+	FParkourTraversalAsyncInput* Input = AsyncCallback->GetProducerInputData_External();
+	Input->Serial = ++AsyncInputSerial;
+	Input->MaxSlideCalls = GetMaxSlideCalls();
+	Input->Characters.Reset(Characters.Num());
+
+	for (int32 Index = 0; Index < Characters.Num(); Index++)
+	{
+		const Aparkour_GP4Character* Character = Characters[Index].Get();
+		if (Character == nullptr)
+		{
+			continue;
+		}
+
+		FParkourTraversalAsyncCharacterInput& CharacterInput = Input->Characters.AddDefaulted_GetRef();
+		CharacterInput.Character = Characters[Index];
+
+		const Uparkour_GP4MovementComponent* Movement = Character->GetParkourMovement();
+		CharacterInput.bSprintSimulated = Movement && Movement->ShouldUpdateSprintState();
+		if (CharacterInput.bSprintSimulated)
+		{
+			CharacterInput.SprintState = Movement->GetSprintState();
+			CharacterInput.TimeInSprintState = Movement->GetTimeInSprintState();
+			CharacterInput.Speed2D = Movement->Velocity.Size2D();
+			CharacterInput.bMovingWithInput = CharacterInput.Speed2D > Movement->SprintStartMinSpeed && !Movement->GetCurrentAcceleration().IsZero();
+			CharacterInput.bWantsToSprint = Movement->WantsToSprint();
+			CharacterInput.bFalling = Movement->IsFalling();
+			CharacterInput.SprintSustainTime = Movement->SprintSustainTime;
+			CharacterInput.RunToStopMinSpeed = Movement->RunToStopMinSpeed;
+		}
+
+		for (int32 Timer = 0; Timer < NumSlideTimers; Timer++)
+		{
+			CharacterInput.SlideInterval[Timer] = SlideInterval[Timer][Index];
+			CharacterInput.bSlideRestarted[Timer] = SlideRestarted[Timer][Index];
+			SlideRestarted[Timer][Index] = false;
+		}
+	}
+}
+
+TStatId Uparkour_GP4TraversalTickManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(Uparkour_GP4TraversalTickManager, STATGROUP_Tickables);
+}
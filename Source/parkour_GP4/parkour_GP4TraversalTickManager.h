@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "parkour_GP4MovementComponent.h"
+#include "parkour_GP4TraversalTickManager.generated.h"
+
+class Aparkour_GP4Character;
+class FParkourTraversalAsyncCallback;
+struct FParkourTraversalAsyncOutput;
+
+/** Repeating slide checks scheduled through the tick manager instead of the timer manager. */
+enum class EParkourSlideTimer : uint8
+{
+	FloorCheck,
+	ContinueSliding,
+	Num
+};
+
+/**
+ * Runs the per frame traversal work of every parkour character in one pass.
+ * The slide timers live here for the whole slide, in arrays indexed by character, and are stepped together with the sprint state machines.
+ * A slide timer is called once for every interval that passed, like the looping timers it replaces, up to parkour.TraversalTick.MaxSlideCalls per step.
+ *
+ * With parkour.TraversalTick.Fixed the stepping moves to FParkourTraversalAsyncCallback instead, which runs once per physics step,
+ * at a fixed rate when physics ticks async. The manager then only sends the inputs and applies the results of every step.
+ */
+UCLASS()
+class Uparkour_GP4TraversalTickManager : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** If new slide timers go through the manager, otherwise they are started on the timer manager. */
+	static bool IsBatchingEnabled();
+
+	/** Maximum number of calls of one slide timer in one step. */
+	static int32 GetMaxSlideCalls();
+
+	/** Counts a slide timer down by DeltaTime and returns how often it expired, at most MaxCalls. Touches no UObjects. */
+	static int32 StepSlideTimer(float& TimeLeft, float Interval, float DeltaTime, int32 MaxCalls);
+
+	void Register(Aparkour_GP4Character* Character);
+	void Unregister(Aparkour_GP4Character* Character);
+
+	/** Calls the slide timer's function every Interval seconds until it is stopped, like a looping timer. */
+	void StartSlideTimer(Aparkour_GP4Character* Character, EParkourSlideTimer Timer, float Interval);
+	void StopSlideTimer(Aparkour_GP4Character* Character, EParkourSlideTimer Timer);
+	bool IsSlideTimerActive(const Aparkour_GP4Character* Character, EParkourSlideTimer Timer) const;
+
+	/** Every parkour character that has begun play in this world. */
+	const TArray<TWeakObjectPtr<Aparkour_GP4Character>>& GetCharacters() const { return Characters; }
+
+private:
+	void RemoveAt(int32 Index);
+	void SetSprintBatched(bool bBatched);
+
+	// Fixed step mode.
+	void SetFixedStep(bool bFixed);
+	void TickFixed();
+	void ApplyAsyncOutput(const FParkourTraversalAsyncOutput& Output);
+	void SendAsyncInput();
+	void CallDueSlideTimers(EParkourSlideTimer Timer, float StepDeltaTime);
+
+	static constexpr int32 NumSlideTimers = static_cast<int32>(EParkourSlideTimer::Num);
+
+	// One entry per registered character, all arrays share the index stored in the character.
+	TArray<TWeakObjectPtr<Aparkour_GP4Character>> Characters;
+	TArray<float> SlideTimeLeft[NumSlideTimers];
+	TArray<float> SlideInterval[NumSlideTimers];
+	/** Calls still owed this step, stopping or restarting the timer drops them. */
+	TArray<int32> SlideCalls[NumSlideTimers];
+
+	// Timer restarts not sent to the physics thread yet, and the serial of the input that carries the last restart.
+	TArray<bool> SlideRestarted[NumSlideTimers];
+	TArray<uint32> SlideRestartSerial[NumSlideTimers];
+
+	TArray<TWeakObjectPtr<Aparkour_GP4Character>> DueCharacters;
+	bool bSprintBatched = false;
+
+	FParkourTraversalAsyncCallback* AsyncCallback = nullptr;
+	uint32 AsyncInputSerial = 0;
+};